@@ -0,0 +1,94 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Construct/destroy throughput of savers for type larger than inline threshold, per thread count:
+// arena_storage (thread-local LIFO arena), small_storage (thread-local pool) and snapshot allocated with operator new.
+// Build with -DSTATE_SAVER_OPT_BUILD_BENCHMARKS=ON -DCMAKE_BUILD_TYPE=Release.
+
+#include <state_saver_arena.hpp>
+#include <state_saver_small.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+struct record {
+  long values[128];
+};
+
+// Returns millions of saver scopes per second of all threads.
+template <typename Scope>
+double run(int threads_count, Scope scope) {
+  std::atomic<bool> stop{false};
+  std::atomic<long long> scopes{0};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < threads_count; ++i) {
+    threads.emplace_back([&]() {
+      record object{};
+      long long count = 0;
+      while (!stop.load(std::memory_order_relaxed)) {
+        scope(object, count);
+        ++count;
+      }
+      scopes += count + (object.values[0] == -1 ? 1 : 0);
+    });
+  }
+
+  const auto duration = std::chrono::milliseconds{500};
+  std::this_thread::sleep_for(duration);
+  stop = true;
+  for (auto& t : threads) {
+    t.join();
+  }
+  return static_cast<double>(scopes.load()) / std::chrono::duration<double, std::micro>(duration).count();
+}
+
+int main() {
+  const int max_threads = static_cast<int>(std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1);
+
+  std::cout << "threads, arena_storage Mscopes/s, small_storage Mscopes/s, operator new Mscopes/s" << std::endl;
+  for (int threads = 1; threads <= max_threads; threads *= 2) {
+    const double arena_rate = run(threads, [](record& object, long long i) {
+      state_saver::saver_exit<record&, state_saver::arena_storage> saver{object};
+      object.values[0] = static_cast<long>(i);
+    });
+
+    const double small_rate = run(threads, [](record& object, long long i) {
+      state_saver::saver_exit<record&, state_saver::small_storage> saver{object};
+      object.values[0] = static_cast<long>(i);
+    });
+
+    const double heap_rate = run(threads, [](record& object, long long i) {
+      std::unique_ptr<record> previous{new record(object)};
+      object.values[0] = static_cast<long>(i);
+      object = *previous;
+    });
+
+    std::cout << threads << ", " << arena_rate << ", " << small_rate << ", " << heap_rate << std::endl;
+  }
+
+  return EXIT_SUCCESS;
+}
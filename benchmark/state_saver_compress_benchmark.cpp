@@ -0,0 +1,100 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Snapshot construction and restore latency of compressed_storage against inline_storage,
+// and compressed size, for zero, periodic and noise inputs.
+// Build with -DSTATE_SAVER_OPT_BUILD_BENCHMARKS=ON -DCMAKE_BUILD_TYPE=Release.
+
+#include <state_saver_compress.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+struct page {
+  unsigned char bytes[16 * 1024];
+};
+
+struct latency {
+  double save_ns;
+  double restore_ns;
+};
+
+// Returns nanoseconds per snapshot construction and per restore.
+template <typename Snapshot>
+latency run(page& object) {
+  constexpr int iterations = 2000;
+  std::vector<std::unique_ptr<Snapshot>> snapshots(iterations);
+
+  const auto start = std::chrono::steady_clock::now();
+  for (auto& snapshot : snapshots) {
+    snapshot.reset(new Snapshot{object});
+  }
+  const auto saved = std::chrono::steady_clock::now();
+  for (auto& snapshot : snapshots) {
+    snapshot->copy_to(object);
+  }
+  const auto restored = std::chrono::steady_clock::now();
+
+  return latency{std::chrono::duration<double, std::nano>(saved - start).count() / iterations,
+                 std::chrono::duration<double, std::nano>(restored - saved).count() / iterations};
+}
+
+void report(const char* name, page& object) {
+  std::vector<unsigned char> compressed;
+  const bool is_compressed = state_saver::detail::compress(object.bytes, sizeof(object.bytes), compressed);
+  const std::size_t size = is_compressed ? compressed.size() : sizeof(object.bytes);
+
+  const latency inline_latency = run<state_saver::inline_storage::snapshot<page>>(object);
+  const latency compressed_latency = run<state_saver::compressed_storage::snapshot<page>>(object);
+
+  std::cout << name << ", " << static_cast<double>(sizeof(object.bytes)) / static_cast<double>(size) << ", "
+            << inline_latency.save_ns << ", " << compressed_latency.save_ns << ", "
+            << inline_latency.restore_ns << ", " << compressed_latency.restore_ns << std::endl;
+}
+
+int main() {
+  std::unique_ptr<page> object{new page{}};
+
+  std::cout << "input, ratio, inline save ns, compressed save ns, inline restore ns, compressed restore ns" << std::endl;
+
+  report("zero", *object);
+
+  for (std::size_t i = 0; i < sizeof(object->bytes); ++i) {
+    object->bytes[i] = static_cast<unsigned char>((i % 64) * 3);
+  }
+  report("periodic", *object);
+
+  std::uint32_t state = 2463534242U;
+  for (auto& byte : object->bytes) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    byte = static_cast<unsigned char>(state);
+  }
+  report("noise", *object);
+
+  return EXIT_SUCCESS;
+}
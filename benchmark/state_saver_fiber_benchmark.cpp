@@ -0,0 +1,75 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Cost of fiber_switch between two fibers with 0, 1 and N active saver_exit_fiber overrides in each.
+// Build with -DSTATE_SAVER_OPT_BUILD_BENCHMARKS=ON -DCMAKE_BUILD_TYPE=Release.
+
+#include <state_saver_fiber.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+thread_local int fiber_values[64];
+
+// Returns nanoseconds per switch between two fibers, each with overrides of the first count values.
+double run(int count) {
+  state_saver::fiber_state& thread_state = state_saver::fiber_state::current();
+  state_saver::fiber_state a;
+  state_saver::fiber_state b;
+  std::vector<std::unique_ptr<state_saver::saver_exit_fiber<int&>>> savers;
+
+  for (state_saver::fiber_state* fiber : {&a, &b}) {
+    state_saver::fiber_switch(*fiber);
+    for (int i = 0; i < count; ++i) {
+      savers.emplace_back(new state_saver::saver_exit_fiber<int&>{fiber_values[i]});
+      fiber_values[i] = i;
+    }
+  }
+
+  constexpr int iterations = 1000000;
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    state_saver::fiber_switch((i & 1) == 0 ? a : b);
+  }
+  const auto duration = std::chrono::steady_clock::now() - start;
+
+  // Savers are destroyed in reverse order, each in own fiber.
+  while (!savers.empty()) {
+    state_saver::fiber_switch(savers.size() > static_cast<std::size_t>(count) ? b : a);
+    savers.pop_back();
+  }
+  state_saver::fiber_switch(thread_state);
+
+  return std::chrono::duration<double, std::nano>(duration).count() / iterations;
+}
+
+int main() {
+  std::cout << "overrides per fiber, ns/switch" << std::endl;
+  for (int count : {0, 1, 4, 16, 64}) {
+    std::cout << count << ", " << run(count) << std::endl;
+  }
+
+  return EXIT_SUCCESS;
+}
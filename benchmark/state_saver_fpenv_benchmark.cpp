@@ -0,0 +1,92 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Denormal-heavy loop with default MXCSR, and inside saver_exit_mxcsr / saver_exit_fpenv scope which sets FTZ/DAZ.
+// Build with -DSTATE_SAVER_OPT_BUILD_BENCHMARKS=ON -DCMAKE_BUILD_TYPE=Release.
+
+#include <state_saver_fpenv.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#if defined(NEARGYE_STATE_SAVER_MXCSR)
+
+constexpr unsigned int ftz_daz = 0x8040; // FTZ (bit 15) and DAZ (bit 6).
+
+// Every product and sum stays in denormal range unless FTZ/DAZ flushes it to zero.
+float kernel(std::vector<float>& data) {
+  float sum = 0.0f;
+  for (int round = 0; round < 200; ++round) {
+    for (auto& x : data) {
+      x = x * 0.75f + 1e-41f;
+      sum += x;
+    }
+  }
+  return sum;
+}
+
+// Returns milliseconds of the loop.
+template <typename Scope>
+double run(Scope scope) {
+  std::vector<float> data(16 * 1024, 1e-39f);
+  const auto start = std::chrono::steady_clock::now();
+  const float sum = scope(data);
+  const auto duration = std::chrono::steady_clock::now() - start;
+  if (sum < 0.0f) {
+    std::cout << sum << std::endl; // Keeps the result alive.
+  }
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+int main() {
+  const unsigned int mxcsr = _mm_getcsr();
+
+  const double plain = run([](std::vector<float>& data) { return kernel(data); });
+  const double mxcsr_time = run([](std::vector<float>& data) {
+    state_saver::saver_exit_mxcsr saver;
+    _mm_setcsr(_mm_getcsr() | ftz_daz);
+    return kernel(data);
+  });
+  const double fpenv_time = run([](std::vector<float>& data) {
+    state_saver::saver_exit_fpenv saver;
+    _mm_setcsr(_mm_getcsr() | ftz_daz);
+    return kernel(data);
+  });
+
+  std::cout << "denormals ms, saver_exit_mxcsr FTZ/DAZ ms, saver_exit_fpenv FTZ/DAZ ms" << std::endl;
+  std::cout << plain << ", " << mxcsr_time << ", " << fpenv_time << std::endl;
+  // Exception flags are sticky and set by the loop itself, only FTZ/DAZ are compared.
+  std::cout << "FTZ/DAZ restored: " << ((_mm_getcsr() & ftz_daz) == (mxcsr & ftz_daz) ? "yes" : "no") << std::endl;
+
+  return EXIT_SUCCESS;
+}
+
+#else
+
+int main() {
+  std::cout << "MXCSR is available only on x86." << std::endl;
+  return EXIT_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,100 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Throughput of threads which override and restore an object guarded by mutex with saver_exit_locked,
+// against the same work done with copy and assignment under the lock.
+// Build with -DSTATE_SAVER_OPT_BUILD_BENCHMARKS=ON -DCMAKE_BUILD_TYPE=Release.
+
+#include <state_saver_sync.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using table = std::vector<long>;
+
+// Returns millions of override-restore rounds per second of all threads.
+template <typename Round>
+double run(int threads_count, Round round) {
+  std::atomic<bool> stop{false};
+  std::atomic<long long> rounds{0};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < threads_count; ++i) {
+    threads.emplace_back([&, i]() {
+      const table desired(1024, i);
+      long long count = 0;
+      while (!stop.load(std::memory_order_relaxed)) {
+        round(desired);
+        ++count;
+      }
+      rounds += count;
+    });
+  }
+
+  const auto duration = std::chrono::milliseconds{500};
+  std::this_thread::sleep_for(duration);
+  stop = true;
+  for (auto& t : threads) {
+    t.join();
+  }
+  return static_cast<double>(rounds.load()) / std::chrono::duration<double, std::micro>(duration).count();
+}
+
+int main() {
+  const int max_threads = static_cast<int>(std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1);
+
+  std::cout << "threads, saver_exit_locked Mrounds/s, lock-around-copy Mrounds/s" << std::endl;
+  for (int threads = 1; threads <= max_threads; threads *= 2) {
+    table saver_object(1024, 0);
+    std::mutex saver_mutex;
+    const double saver_rate = run(threads, [&](const table& desired) {
+      state_saver::saver_exit_locked<decltype(saver_object), decltype(saver_mutex)> saver{saver_object, saver_mutex};
+      table value{desired};
+      std::lock_guard<std::mutex> lock{saver_mutex};
+      saver_object.swap(value);
+    });
+
+    table plain_object(1024, 0);
+    std::mutex plain_mutex;
+    const double plain_rate = run(threads, [&](const table& desired) {
+      table previous;
+      {
+        std::lock_guard<std::mutex> lock{plain_mutex};
+        previous = plain_object;
+      }
+      {
+        std::lock_guard<std::mutex> lock{plain_mutex};
+        plain_object = desired;
+      }
+      std::lock_guard<std::mutex> lock{plain_mutex};
+      plain_object = previous;
+    });
+
+    std::cout << threads << ", " << saver_rate << ", " << plain_rate << std::endl;
+  }
+
+  return EXIT_SUCCESS;
+}
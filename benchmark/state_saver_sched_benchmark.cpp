@@ -0,0 +1,87 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Cost of one saver scope for thread attributes, when the desired value differs from the current one,
+// when it is the same (no syscall on restore) and for saver created without desired value.
+// Build with -DSTATE_SAVER_OPT_BUILD_BENCHMARKS=ON -DCMAKE_BUILD_TYPE=Release.
+
+#include <state_saver_sched.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#if defined(__linux__)
+
+// Returns nanoseconds per call of scope.
+template <typename Scope>
+double run(Scope scope) {
+  constexpr int iterations = 100000;
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    scope();
+  }
+  const auto duration = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::nano>(duration).count() / iterations;
+}
+
+int main() {
+  const cpu_set_t affinity = state_saver::detail::affinity_traits::get();
+  cpu_set_t pinned;
+  CPU_ZERO(&pinned);
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &affinity)) {
+      CPU_SET(cpu, &pinned);
+      break;
+    }
+  }
+  const unsigned long slack = state_saver::detail::timer_slack_traits::get();
+  const state_saver::sched_state sched = state_saver::detail::sched_traits::get();
+
+  std::cout << "attribute, changed ns/scope, unchanged ns/scope, save only ns/scope" << std::endl;
+
+  std::cout << "affinity, "
+            << run([&pinned]() { state_saver::saver_exit_affinity saver{pinned}; }) << ", "
+            << run([&affinity]() { state_saver::saver_exit_affinity saver{affinity}; }) << ", "
+            << run([]() { state_saver::saver_exit_affinity saver; }) << std::endl;
+
+  std::cout << "timer_slack, "
+            << run([slack]() { state_saver::saver_exit_timer_slack saver{slack + 1000}; }) << ", "
+            << run([slack]() { state_saver::saver_exit_timer_slack saver{slack}; }) << ", "
+            << run([]() { state_saver::saver_exit_timer_slack saver; }) << std::endl;
+
+  // Lowering nice value back requires privileges, so changed sched is not measured.
+  std::cout << "sched, -, "
+            << run([&sched]() { state_saver::saver_exit_sched saver{sched}; }) << ", "
+            << run([]() { state_saver::saver_exit_sched saver; }) << std::endl;
+
+  return EXIT_SUCCESS;
+}
+
+#else
+
+int main() {
+  std::cout << "state_saver_sched.hpp is available only on Linux." << std::endl;
+  return EXIT_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,112 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Reader throughput of seqlocked value against mutex-protected value, while writer keeps overriding it with saver_exit_seqlock.
+// Build with -DSTATE_SAVER_OPT_BUILD_BENCHMARKS=ON -DCMAKE_BUILD_TYPE=Release.
+
+#include <state_saver_sync.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct config {
+  long first;
+  long second;
+};
+
+class mutex_config {
+  mutable std::mutex mutex_;
+  config value_;
+
+ public:
+  mutex_config() : mutex_{}, value_{0, 0} {}
+
+  config load() const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    return value_;
+  }
+
+  void store(const config& value) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    value_ = value;
+  }
+};
+
+// Returns millions of reads per second of all readers.
+template <typename Read, typename Write>
+double run(int readers, Read read, Write write) {
+  std::atomic<bool> stop{false};
+  std::atomic<long long> reads{0};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < readers; ++i) {
+    threads.emplace_back([&]() {
+      long long count = 0;
+      long sum = 0;
+      while (!stop.load(std::memory_order_relaxed)) {
+        sum += read().first;
+        ++count;
+      }
+      reads += count + (sum == -1 ? 1 : 0);
+    });
+  }
+  std::thread writer{[&]() {
+    for (long i = 0; !stop.load(std::memory_order_relaxed); ++i) {
+      write(i);
+      std::this_thread::sleep_for(std::chrono::microseconds{10});
+    }
+  }};
+
+  const auto duration = std::chrono::milliseconds{500};
+  std::this_thread::sleep_for(duration);
+  stop = true;
+  writer.join();
+  for (auto& t : threads) {
+    t.join();
+  }
+  return static_cast<double>(reads.load()) / std::chrono::duration<double, std::micro>(duration).count();
+}
+
+int main() {
+  const int max_readers = static_cast<int>(std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 1);
+
+  std::cout << "readers, seqlocked Mreads/s, mutex Mreads/s" << std::endl;
+  for (int readers = 1; readers <= max_readers; readers *= 2) {
+    state_saver::seqlocked<config> seq{config{0, 0}};
+    const double seq_rate = run(readers,
+                                [&seq]() { return seq.load(); },
+                                [&seq](long i) { state_saver::saver_exit_seqlock<decltype(seq)> saver{seq, config{i, -i}}; });
+
+    mutex_config mtx;
+    const double mtx_rate = run(readers,
+                                [&mtx]() { return mtx.load(); },
+                                [&mtx](long i) { const config previous = mtx.load(); mtx.store(config{i, -i}); mtx.store(previous); });
+
+    std::cout << readers << ", " << seq_rate << ", " << mtx_rate << std::endl;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -36,7 +36,11 @@
 #define STATE_SAVER_VERSION_MINOR 9
 #define STATE_SAVER_VERSION_PATCH 0
 
+#include <atomic>
+#include <cstddef>
+#include <tuple>
 #include <type_traits>
+#include <utility>
 #if (defined(_MSC_VER) && _MSC_VER >= 1900) || ((defined(__clang__) || defined(__GNUC__)) && __cplusplus >= 201700L)
 #include <exception>
 #endif
@@ -74,12 +78,26 @@ namespace detail {
 #  define NEARGYE_NOEXCEPT(...) noexcept
 #  define NEARGYE_TRY try {
 #  define NEARGYE_CATCH } catch (...) { STATE_SAVER_CATCH_HANDLER }
+// Whether restore with given noexcept specification is noexcept, taking throwable settings into account.
+template <bool>
+struct is_noexcept_restore : std::true_type {};
 #else
 #  define NEARGYE_NOEXCEPT(...) noexcept(__VA_ARGS__)
 #  define NEARGYE_TRY
 #  define NEARGYE_CATCH
+// Whether restore with given noexcept specification is noexcept, taking throwable settings into account.
+template <bool B>
+struct is_noexcept_restore : std::integral_constant<bool, B> {};
 #endif
 
+// Invokes restore action, taking throwable settings into account.
+template <typename F>
+void invoke_restore(F&& f) NEARGYE_NOEXCEPT(noexcept(f())) {
+  NEARGYE_TRY
+    f();
+  NEARGYE_CATCH
+}
+
 #if defined(_MSC_VER) && _MSC_VER < 1900
 inline int uncaught_exceptions() noexcept {
   return *(reinterpret_cast<int*>(static_cast<char*>(static_cast<void*>(_getptd())) + (sizeof(void*) == 8 ? 0x100 : 0x90)));
@@ -96,6 +114,28 @@ inline int uncaught_exceptions() noexcept {
 }
 #endif
 
+template <typename...>
+struct make_void {
+  using type = void;
+};
+
+// Policy concept, required by state_saver<U, P>:
+// * explicit P(bool execute) noexcept - construct policy, with execute == false the policy is dismissed from the start.
+// * void dismiss() noexcept - after the call should_execute() must return false.
+// * bool should_execute() const noexcept - checked once on scope exit, decides whether restore takes place.
+template <typename P, typename = void>
+struct is_policy : std::false_type {};
+
+template <typename P>
+struct is_policy<P, typename make_void<decltype(std::declval<P&>().dismiss()),
+                                       decltype(std::declval<const P&>().should_execute())>::type>
+    : std::integral_constant<bool, std::is_nothrow_constructible<P, bool>::value &&
+                                   !std::is_convertible<bool, P>::value &&
+                                   std::is_nothrow_destructible<P>::value &&
+                                   noexcept(std::declval<P&>().dismiss()) &&
+                                   noexcept(std::declval<const P&>().should_execute()) &&
+                                   std::is_convertible<decltype(std::declval<const P&>().should_execute()), bool>::value> {};
+
 class on_exit_policy {
   bool execute_;
 
@@ -141,20 +181,60 @@ class on_success_policy {
   }
 };
 
-template <typename U, typename P>
-class state_saver {
-  using T = typename std::remove_reference<U>::type;
+template <typename T>
+struct assignable {
 #if defined(STATE_SAVER_FORCE_MOVE_ASSIGNABLE)
-  using assignable_t = T&&;
+  using type = T&&;
 #elif defined(STATE_SAVER_FORCE_COPY_ASSIGNABLE)
-  using assignable_t = T&;
+  using type = T&;
 #else
-  using assignable_t = typename std::conditional<
+  using type = typename std::conditional<
       std::is_nothrow_assignable<T&, T&&>::value ||
           !std::is_assignable<T&, T&>::value ||
           (!std::is_nothrow_assignable<T&, T&>::value && std::is_assignable<T&, T&&>::value),
       T&&, T&>::type;
 #endif
+};
+
+// Storage concept, required by state_saver<U, P, S>:
+// * explicit S::snapshot<T>(T& object) - saves the object.
+// * void copy_to(T& object) - restores the object, the snapshot stays valid.
+// * void move_to(T& object) - restores the object on scope exit, the snapshot is not used after the call.
+template <typename S, typename T, typename = void>
+struct is_storage : std::false_type {};
+
+template <typename S, typename T>
+struct is_storage<S, T, typename make_void<decltype(std::declval<typename S::template snapshot<T>&>().copy_to(std::declval<T&>())),
+                                           decltype(std::declval<typename S::template snapshot<T>&>().move_to(std::declval<T&>()))>::type>
+    : std::integral_constant<bool, std::is_constructible<typename S::template snapshot<T>, T&>::value &&
+                                   std::is_nothrow_destructible<typename S::template snapshot<T>>::value> {};
+
+// Keeps snapshot by value inside the saver.
+struct inline_storage {
+  template <typename T>
+  class snapshot {
+    using assignable_t = typename assignable<T>::type;
+
+    T value_;
+
+   public:
+    explicit snapshot(T& object) noexcept(std::is_nothrow_constructible<T, T&>::value) : value_{object} {}
+
+    void copy_to(T& object) noexcept(std::is_nothrow_assignable<T&, T&>::value) {
+      object = value_;
+    }
+
+    void move_to(T& object) noexcept(std::is_nothrow_assignable<T&, assignable_t>::value) {
+      object = static_cast<assignable_t>(value_);
+    }
+  };
+};
+
+template <typename U, typename P, typename S = inline_storage>
+class state_saver {
+  using T = typename std::remove_reference<U>::type;
+  using assignable_t = typename assignable<T>::type;
+  using snapshot_t = typename S::template snapshot<T>;
 
   static_assert(!std::is_const<T>::value,
                 "state_saver requires not const type.");
@@ -170,11 +250,15 @@ class state_saver {
                 "state_saver requires copy constructible.");
   static_assert(std::is_assignable<T&, assignable_t>::value,
                 "state_saver requires operator=.");
-  static_assert(std::is_same<P, on_exit_policy>::value || std::is_same<P, on_fail_policy>::value || std::is_same<P, on_success_policy>::value,
-                "state_saver requires on_exit_policy, on_fail_policy or on_success_policy.");
+  static_assert(is_policy<P>::value,
+                "state_saver requires policy with explicit P(bool) noexcept, dismiss() noexcept and should_execute() const noexcept.");
+  static_assert(is_storage<S, T>::value,
+                "state_saver requires storage with explicit S::snapshot<T>(T&), copy_to(T&) and move_to(T&).");
 #if defined(STATE_SAVER_NO_THROW_RESTORE)
   static_assert(std::is_nothrow_assignable<T&, assignable_t>::value,
                 "state_saver requires noexcept operator=.");
+  static_assert(noexcept(std::declval<snapshot_t&>().move_to(std::declval<T&>())),
+                "state_saver requires storage with noexcept move_to.");
 #endif
 #if defined(STATE_SAVER_NO_THROW_CONSTRUCTIBLE)
   static_assert(std::is_nothrow_constructible<T, T&>::value,
@@ -183,7 +267,7 @@ class state_saver {
 
   P policy_;
   T& previous_ref_;
-  T previous_value_;
+  snapshot_t previous_value_;
 
  public:
   state_saver() = delete;
@@ -195,7 +279,7 @@ class state_saver {
   state_saver(T&&) = delete;
   state_saver(const T&) = delete;
 
-  explicit state_saver(T& object) noexcept(std::is_nothrow_constructible<T, T&>::value)
+  explicit state_saver(T& object) noexcept(std::is_nothrow_constructible<snapshot_t, T&>::value)
       : policy_{true},
         previous_ref_{object},
         previous_value_{object} {}
@@ -205,49 +289,806 @@ class state_saver {
   }
 
   template <typename O = T>
-  auto restore() NEARGYE_NOEXCEPT(std::is_nothrow_assignable<O&, O&>::value) -> typename std::enable_if<std::is_same<T, O>::value && std::is_assignable<O&, O&>::value>::type {
+  auto restore() NEARGYE_NOEXCEPT(noexcept(std::declval<snapshot_t&>().copy_to(std::declval<O&>()))) -> typename std::enable_if<std::is_same<T, O>::value && std::is_assignable<O&, O&>::value>::type {
     static_assert(std::is_assignable<O&, O&>::value, "state_saver::restore requires copy operator=.");
 #if defined(STATE_SAVER_NO_THROW_RESTORE)
     static_assert(std::is_nothrow_assignable<O&, O&>::value, "state_saver::restore requires noexcept copy operator=.");
+    static_assert(noexcept(std::declval<snapshot_t&>().copy_to(std::declval<O&>())), "state_saver::restore requires storage with noexcept copy_to.");
 #endif
     NEARGYE_TRY
-      previous_ref_ = previous_value_;
+      previous_value_.copy_to(previous_ref_);
     NEARGYE_CATCH
   }
 
-  ~state_saver() NEARGYE_NOEXCEPT(std::is_nothrow_assignable<T&, assignable_t>::value) {
+  ~state_saver() NEARGYE_NOEXCEPT(noexcept(std::declval<snapshot_t&>().move_to(std::declval<T&>()))) {
     if (policy_.should_execute()) {
       NEARGYE_TRY
-        previous_ref_ = static_cast<assignable_t>(previous_value_);
+        previous_value_.move_to(previous_ref_);
       NEARGYE_CATCH
     }
   }
 };
 
+// Memory order valid for load, derived from memory order of store.
+constexpr std::memory_order load_order(std::memory_order order) noexcept {
+  return order == std::memory_order_release ? std::memory_order_relaxed
+       : order == std::memory_order_acq_rel ? std::memory_order_acquire
+       : order;
+}
+
+// Memory order valid for store, derived from memory order of load.
+constexpr std::memory_order store_order(std::memory_order order) noexcept {
+  return order == std::memory_order_consume ? std::memory_order_relaxed
+       : order == std::memory_order_acquire ? std::memory_order_relaxed
+       : order == std::memory_order_acq_rel ? std::memory_order_release
+       : order;
+}
+
+template <typename U, typename P, typename T = typename std::remove_reference<U>::type>
+class bits_saver {
+  static_assert(!std::is_const<T>::value,
+                "bits_saver requires not const type.");
+  static_assert(!std::is_rvalue_reference<U>::value && (std::is_lvalue_reference<U>::value || std::is_same<T, U>::value),
+                "bits_saver requires lvalue type.");
+  static_assert(std::is_integral<T>::value && !std::is_same<T, bool>::value,
+                "bits_saver requires integral type.");
+  static_assert(is_policy<P>::value,
+                "bits_saver requires policy with explicit P(bool) noexcept, dismiss() noexcept and should_execute() const noexcept.");
+
+  P policy_;
+  T& previous_ref_;
+  T mask_;
+  T previous_bits_;
+
+ public:
+  bits_saver() = delete;
+  bits_saver(const bits_saver&) = delete;
+  bits_saver(bits_saver&&) = delete;
+  bits_saver& operator=(const bits_saver&) = delete;
+  bits_saver& operator=(bits_saver&&) = delete;
+
+  bits_saver(T&&, T) = delete;
+  bits_saver(const T&, T) = delete;
+
+  bits_saver(T& object, T mask) noexcept
+      : policy_{true},
+        previous_ref_{object},
+        mask_{mask},
+        previous_bits_{static_cast<T>(object & mask)} {}
+
+  void dismiss() noexcept {
+    policy_.dismiss();
+  }
+
+  void restore() noexcept {
+    previous_ref_ = static_cast<T>((previous_ref_ & static_cast<T>(~mask_)) | previous_bits_);
+  }
+
+  ~bits_saver() noexcept {
+    if (policy_.should_execute()) {
+      restore();
+    }
+  }
+};
+
+template <typename U, typename P, typename I>
+class bits_saver<U, P, std::atomic<I>> {
+  using T = std::atomic<I>;
+
+  static_assert(!std::is_rvalue_reference<U>::value && (std::is_lvalue_reference<U>::value || std::is_same<T, U>::value),
+                "bits_saver requires lvalue type.");
+  static_assert(std::is_integral<I>::value && !std::is_same<I, bool>::value,
+                "bits_saver requires atomic integral type.");
+  static_assert(is_policy<P>::value,
+                "bits_saver requires policy with explicit P(bool) noexcept, dismiss() noexcept and should_execute() const noexcept.");
+
+  P policy_;
+  T& previous_ref_;
+  I mask_;
+  I previous_bits_;
+  std::memory_order order_;
+
+ public:
+  bits_saver() = delete;
+  bits_saver(const bits_saver&) = delete;
+  bits_saver(bits_saver&&) = delete;
+  bits_saver& operator=(const bits_saver&) = delete;
+  bits_saver& operator=(bits_saver&&) = delete;
+
+  bits_saver(T& object, I mask, std::memory_order order = std::memory_order_seq_cst) noexcept
+      : policy_{true},
+        previous_ref_{object},
+        mask_{mask},
+        previous_bits_{static_cast<I>(object.load(load_order(order)) & mask)},
+        order_{order} {}
+
+  void dismiss() noexcept {
+    policy_.dismiss();
+  }
+
+  // Only masked bits are written, so concurrent changes of other bits are preserved.
+  void restore() noexcept {
+    const I clear_bits = static_cast<I>(mask_ & static_cast<I>(~previous_bits_));
+    if (clear_bits != 0) {
+      previous_ref_.fetch_and(static_cast<I>(~clear_bits), order_);
+    }
+    if (previous_bits_ != 0) {
+      previous_ref_.fetch_or(previous_bits_, order_);
+    }
+  }
+
+  ~bits_saver() noexcept {
+    if (policy_.should_execute()) {
+      restore();
+    }
+  }
+};
+
+template <typename U, typename P, typename T = typename std::remove_reference<U>::type>
+class atomic_saver {
+  static_assert(sizeof(T) == 0,
+                "atomic_saver requires std::atomic type.");
+};
+
+template <typename R, typename P, typename U>
+class atomic_saver<R, P, std::atomic<U>> {
+  using T = std::atomic<U>;
+
+  static_assert(!std::is_rvalue_reference<R>::value && (std::is_lvalue_reference<R>::value || std::is_same<T, R>::value),
+                "atomic_saver requires lvalue type.");
+  static_assert(std::is_trivially_copyable<U>::value,
+                "atomic_saver requires atomic of trivially copyable type.");
+  static_assert(is_policy<P>::value,
+                "atomic_saver requires policy with explicit P(bool) noexcept, dismiss() noexcept and should_execute() const noexcept.");
+
+  P policy_;
+  T& previous_ref_;
+  U previous_value_;
+  U desired_value_;
+  bool conditional_;
+  std::memory_order order_;
+
+ public:
+  atomic_saver() = delete;
+  atomic_saver(const atomic_saver&) = delete;
+  atomic_saver(atomic_saver&&) = delete;
+  atomic_saver& operator=(const atomic_saver&) = delete;
+  atomic_saver& operator=(atomic_saver&&) = delete;
+
+  // Saves the current value, on scope exit restores it with plain store.
+  explicit atomic_saver(T& object, std::memory_order order = std::memory_order_seq_cst) noexcept
+      : policy_{true},
+        previous_ref_{object},
+        previous_value_{object.load(load_order(order))},
+        desired_value_{previous_value_},
+        conditional_{false},
+        order_{order} {}
+
+  // Exchanges the value with desired, on scope exit restores the saved value only if the object still holds desired.
+  atomic_saver(T& object, U desired, std::memory_order order = std::memory_order_seq_cst) noexcept
+      : policy_{true},
+        previous_ref_{object},
+        previous_value_{object.exchange(desired, order)},
+        desired_value_{desired},
+        conditional_{true},
+        order_{order} {}
+
+  void dismiss() noexcept {
+    policy_.dismiss();
+  }
+
+  // Returns true if the saved value was written.
+  bool restore() noexcept {
+    if (conditional_) {
+      U expected = desired_value_;
+      return previous_ref_.compare_exchange_strong(expected, previous_value_, order_);
+    }
+    previous_ref_.store(previous_value_, store_order(order_));
+    return true;
+  }
+
+  ~atomic_saver() noexcept {
+    if (policy_.should_execute()) {
+      restore();
+    }
+  }
+};
+
+#if defined(__cpp_nontype_template_parameter_auto) && __cpp_nontype_template_parameter_auto >= 201606L
+template <typename M>
+struct member_pointer_traits {};
+
+template <typename C, typename F>
+struct member_pointer_traits<F C::*> {
+  using class_type = C;
+  using field_type = F;
+};
+
+template <auto M, auto...>
+struct first_member_pointer {
+  using class_type = typename member_pointer_traits<decltype(M)>::class_type;
+};
+
+template <typename P, auto... Ms>
+class fields_saver {
+  static_assert(sizeof...(Ms) > 0,
+                "fields_saver requires at least one field.");
+  static_assert((std::is_member_object_pointer<decltype(Ms)>::value && ...),
+                "fields_saver requires pointers to data members.");
+
+  using T = typename first_member_pointer<Ms...>::class_type;
+
+  static_assert((std::is_same<T, typename member_pointer_traits<decltype(Ms)>::class_type>::value && ...),
+                "fields_saver requires fields of the same class.");
+  static_assert(!std::is_const<T>::value,
+                "fields_saver requires not const type.");
+  static_assert(!std::is_reference<T>::value && (std::is_class<T>::value || std::is_union<T>::value),
+                "fields_saver requires lvalue type.");
+  static_assert(((!std::is_const<typename member_pointer_traits<decltype(Ms)>::field_type>::value) && ...),
+                "fields_saver requires not const fields.");
+  static_assert((std::is_constructible<typename member_pointer_traits<decltype(Ms)>::field_type,
+                                       typename member_pointer_traits<decltype(Ms)>::field_type&>::value && ...),
+                "fields_saver requires copy constructible fields.");
+  static_assert((std::is_assignable<typename member_pointer_traits<decltype(Ms)>::field_type&,
+                                    typename assignable<typename member_pointer_traits<decltype(Ms)>::field_type>::type>::value && ...),
+                "fields_saver requires operator= of fields.");
+  static_assert(is_policy<P>::value,
+                "fields_saver requires policy with explicit P(bool) noexcept, dismiss() noexcept and should_execute() const noexcept.");
+#if defined(STATE_SAVER_NO_THROW_RESTORE)
+  static_assert((std::is_nothrow_assignable<typename member_pointer_traits<decltype(Ms)>::field_type&,
+                                            typename assignable<typename member_pointer_traits<decltype(Ms)>::field_type>::type>::value && ...),
+                "fields_saver requires noexcept operator= of fields.");
+#endif
+#if defined(STATE_SAVER_NO_THROW_CONSTRUCTIBLE)
+  static_assert((std::is_nothrow_constructible<typename member_pointer_traits<decltype(Ms)>::field_type,
+                                               typename member_pointer_traits<decltype(Ms)>::field_type&>::value && ...),
+                "fields_saver requires nothrow constructible fields.");
+#endif
+
+  static constexpr bool is_nothrow_restore = (std::is_nothrow_assignable<typename member_pointer_traits<decltype(Ms)>::field_type&,
+                                                                         typename assignable<typename member_pointer_traits<decltype(Ms)>::field_type>::type>::value && ...);
+
+  P policy_;
+  T& previous_ref_;
+  std::tuple<typename member_pointer_traits<decltype(Ms)>::field_type...> previous_value_;
+
+  template <std::size_t... I>
+  void copy_fields(std::index_sequence<I...>) {
+    ((previous_ref_.*Ms = std::get<I>(previous_value_)), ...);
+  }
+
+  template <std::size_t... I>
+  void assign_fields(std::index_sequence<I...>) {
+    ((previous_ref_.*Ms = static_cast<typename assignable<typename member_pointer_traits<decltype(Ms)>::field_type>::type>(std::get<I>(previous_value_))), ...);
+  }
+
+ public:
+  fields_saver() = delete;
+  fields_saver(const fields_saver&) = delete;
+  fields_saver(fields_saver&&) = delete;
+  fields_saver& operator=(const fields_saver&) = delete;
+  fields_saver& operator=(fields_saver&&) = delete;
+
+  fields_saver(T&&) = delete;
+  fields_saver(const T&) = delete;
+
+  explicit fields_saver(T& object) noexcept(std::is_nothrow_constructible<decltype(previous_value_), decltype(object.*Ms)...>::value)
+      : policy_{true},
+        previous_ref_{object},
+        previous_value_{object.*Ms...} {}
+
+  void dismiss() noexcept {
+    policy_.dismiss();
+  }
+
+  void restore() NEARGYE_NOEXCEPT((std::is_nothrow_assignable<typename member_pointer_traits<decltype(Ms)>::field_type&,
+                                                              typename member_pointer_traits<decltype(Ms)>::field_type&>::value && ...)) {
+#if defined(STATE_SAVER_NO_THROW_RESTORE)
+    static_assert((std::is_nothrow_assignable<typename member_pointer_traits<decltype(Ms)>::field_type&,
+                                              typename member_pointer_traits<decltype(Ms)>::field_type&>::value && ...),
+                  "fields_saver::restore requires noexcept copy operator= of fields.");
+#endif
+    NEARGYE_TRY
+      copy_fields(std::index_sequence_for<decltype(Ms)...>{});
+    NEARGYE_CATCH
+  }
+
+  ~fields_saver() NEARGYE_NOEXCEPT(is_nothrow_restore) {
+    if (policy_.should_execute()) {
+      NEARGYE_TRY
+        assign_fields(std::index_sequence_for<decltype(Ms)...>{});
+      NEARGYE_CATCH
+    }
+  }
+};
+#endif
+
+#if defined(__cpp_structured_bindings) && __cpp_structured_bindings >= 201606L && defined(__cpp_lib_is_aggregate) && __cpp_lib_is_aggregate >= 201703L
+template <typename T>
+struct any_field {
+  template <typename F, typename = typename std::enable_if<!std::is_same<typename std::remove_cv<F>::type, T>::value>::type>
+  operator F() const noexcept;
+};
+
+template <typename T, std::size_t>
+using any_field_at = any_field<T>;
+
+template <typename T, typename S, typename = void>
+struct is_initializable_by_fields : std::false_type {};
+
+template <typename T, std::size_t... I>
+struct is_initializable_by_fields<T, std::index_sequence<I...>, typename make_void<decltype(T{any_field_at<T, I>{}...})>::type> : std::true_type {};
+
+inline constexpr std::size_t max_fields_count = 32;
+
+// Number of fields of aggregate, found as maximum number of initializers accepted by aggregate initialization.
+// Aggregates with base classes or C array fields are not supported.
+template <typename T, std::size_t N = max_fields_count + 1>
+struct fields_count : std::conditional<is_initializable_by_fields<T, std::make_index_sequence<N>>::value,
+                                       std::integral_constant<std::size_t, N>,
+                                       fields_count<T, N - 1>>::type {};
+
+template <typename T>
+struct fields_count<T, 0> : std::integral_constant<std::size_t, 0> {};
+
+template <typename T>
+auto tie_fields(T& t, std::integral_constant<std::size_t, 1>) noexcept {
+  auto& [f0] = t;
+  return std::tie(f0);
+}
+
+template <typename T>
+auto tie_fields(T& t, std::integral_constant<std::size_t, 2>) noexcept {
+  auto& [f0, f1] = t;
+  return std::tie(f0, f1);
+}
+
+template <typename T>
+auto tie_fields(T& t, std::integral_constant<std::size_t, 3>) noexcept {
+  auto& [f0, f1, f2] = t;
+  return std::tie(f0, f1, f2);
+}
+
+template <typename T>
+auto tie_fields(T& t, std::integral_constant<std::size_t, 4>) noexcept {
+  auto& [f0, f1, f2, f3] = t;
+  return std::tie(f0, f1, f2, f3);
+}
+
+template <typename T>
+auto tie_fields(T& t, std::integral_constant<std::size_t, 5>) noexcept {
+  auto& [f0, f1, f2, f3, f4] = t;
+  return std::tie(f0, f1, f2, f3, f4);
+}
+
+template <typename T>
+auto tie_fields(T& t, std::integral_constant<std::size_t, 6>) noexcept {
+  auto& [f0, f1, f2, f3, f4, f5] = t;
+  return std::tie(f0, f1, f2, f3, f4, f5);
+}
+
+template <typename T>
+auto tie_fields(T& t, std::integral_constant<std::size_t, 7>) noexcept {
+  auto& [f0, f1, f2, f3, f4, f5, f6] = t;
+  return std::tie(f0, f1, f2, f3, f4, f5, f6);
+}
+
+template <typename T>
+auto tie_fields(T& t, std::integral_constant<std::size_t, 8>) noexcept {
+  auto& [f0, f1, f2, f3, f4, f5, f6, f7] = t;
+  return std::tie(f0, f1, f2, f3, f4, f5, f6, f7);
+}
+
+template <typename T>
+auto tie_fields(T& t, std::integral_constant<std::size_t, 9>) noexcept {
+  auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8] = t;
+  return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8);
+}
+
+template <typename T>
+auto tie_fields(T& t, std::integral_constant<std::size_t, 10>) noexcept {
+  auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9] = t;
+  return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9);
+}
+
+template <typename T>
+auto tie_fields(T& t, std::integral_constant<std::size_t, 11>) noexcept {
+  auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10] = t;
+  return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10);
+}
+
+template <typename T>
+auto tie_fields(T& t, std::integral_constant<std::size_t, 12>) noexcept {
+  auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11] = t;
+  return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11);
+}
+
+template <typename T>
+auto tie_fields(T& t, std::integral_constant<std::size_t, 13>) noexcept {
+  auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12] = t;
+  return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12);
+}
+
+template <typename T>
+auto tie_fields(T& t, std::integral_constant<std::size_t, 14>) noexcept {
+  auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13] = t;
+  return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13);
+}
+
+template <typename T>
+auto tie_fields(T& t, std::integral_constant<std::size_t, 15>) noexcept {
+  auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14] = t;
+  return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14);
+}
+
+template <typename T>
+auto tie_fields(T& t, std::integral_constant<std::size_t, 16>) noexcept {
+  auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15] = t;
+  return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15);
+}
+
+template <typename T>
+auto tie_fields(T& t, std::integral_constant<std::size_t, 17>) noexcept {
+  auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16] = t;
+  return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16);
+}
+
+template <typename T>
+auto tie_fields(T& t, std::integral_constant<std::size_t, 18>) noexcept {
+  auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17] = t;
+  return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17);
+}
+
+template <typename T>
+auto tie_fields(T& t, std::integral_constant<std::size_t, 19>) noexcept {
+  auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18] = t;
+  return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18);
+}
+
+template <typename T>
+auto tie_fields(T& t, std::integral_constant<std::size_t, 20>) noexcept {
+  auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19] = t;
+  return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19);
+}
+
+template <typename T>
+auto tie_fields(T& t, std::integral_constant<std::size_t, 21>) noexcept {
+  auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20] = t;
+  return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20);
+}
+
+template <typename T>
+auto tie_fields(T& t, std::integral_constant<std::size_t, 22>) noexcept {
+  auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21] = t;
+  return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21);
+}
+
+template <typename T>
+auto tie_fields(T& t, std::integral_constant<std::size_t, 23>) noexcept {
+  auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22] = t;
+  return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22);
+}
+
+template <typename T>
+auto tie_fields(T& t, std::integral_constant<std::size_t, 24>) noexcept {
+  auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23] = t;
+  return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23);
+}
+
+template <typename T>
+auto tie_fields(T& t, std::integral_constant<std::size_t, 25>) noexcept {
+  auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23, f24] = t;
+  return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23, f24);
+}
+
+template <typename T>
+auto tie_fields(T& t, std::integral_constant<std::size_t, 26>) noexcept {
+  auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23, f24, f25] = t;
+  return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23, f24, f25);
+}
+
+template <typename T>
+auto tie_fields(T& t, std::integral_constant<std::size_t, 27>) noexcept {
+  auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23, f24, f25, f26] = t;
+  return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23, f24, f25, f26);
+}
+
+template <typename T>
+auto tie_fields(T& t, std::integral_constant<std::size_t, 28>) noexcept {
+  auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23, f24, f25, f26, f27] = t;
+  return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23, f24, f25, f26, f27);
+}
+
+template <typename T>
+auto tie_fields(T& t, std::integral_constant<std::size_t, 29>) noexcept {
+  auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23, f24, f25, f26, f27, f28] = t;
+  return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23, f24, f25, f26, f27, f28);
+}
+
+template <typename T>
+auto tie_fields(T& t, std::integral_constant<std::size_t, 30>) noexcept {
+  auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23, f24, f25, f26, f27, f28, f29] = t;
+  return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23, f24, f25, f26, f27, f28, f29);
+}
+
+template <typename T>
+auto tie_fields(T& t, std::integral_constant<std::size_t, 31>) noexcept {
+  auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23, f24, f25, f26, f27, f28, f29, f30] = t;
+  return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23, f24, f25, f26, f27, f28, f29, f30);
+}
+
+template <typename T>
+auto tie_fields(T& t, std::integral_constant<std::size_t, 32>) noexcept {
+  auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23, f24, f25, f26, f27, f28, f29, f30, f31] = t;
+  return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23, f24, f25, f26, f27, f28, f29, f30, f31);
+}
+
+template <typename F, typename = void>
+struct is_equality_comparable : std::false_type {};
+
+template <typename F>
+struct is_equality_comparable<F, typename make_void<decltype(static_cast<bool>(std::declval<const F&>() == std::declval<const F&>()))>::type> : std::true_type {};
+
+// Comparison in assign_if_changed does not throw, fields without operator== are always assigned.
+template <typename F, typename = void>
+struct is_nothrow_equality_comparable : std::true_type {};
+
+template <typename F>
+struct is_nothrow_equality_comparable<F, typename std::enable_if<is_equality_comparable<F>::value>::type>
+    : std::integral_constant<bool, noexcept(static_cast<bool>(std::declval<const F&>() == std::declval<const F&>()))> {};
+
+template <typename F, typename V>
+void assign_if_changed(F& field, V&& value) {
+  if constexpr (is_equality_comparable<F>::value) {
+    if (!(field == value)) {
+      field = static_cast<V&&>(value);
+    }
+  } else {
+    field = static_cast<V&&>(value);
+  }
+}
+
+template <typename U, typename P>
+class diff_saver {
+  using T = typename std::remove_reference<U>::type;
+  using count_t = fields_count<T>;
+  using tie_t = decltype(tie_fields(std::declval<T&>(), count_t{}));
+
+  template <typename S>
+  struct fields_traits;
+
+  template <std::size_t... I>
+  struct fields_traits<std::index_sequence<I...>> {
+    using sequence = std::index_sequence<I...>;
+    static constexpr bool is_nothrow_compare = (is_nothrow_equality_comparable<std::remove_reference_t<std::tuple_element_t<I, tie_t>>>::value && ...);
+    static constexpr bool is_nothrow_copy = is_nothrow_compare &&
+                                            (std::is_nothrow_assignable<std::remove_reference_t<std::tuple_element_t<I, tie_t>>&,
+                                                                        std::remove_reference_t<std::tuple_element_t<I, tie_t>>&>::value && ...);
+    static constexpr bool is_nothrow_restore = is_nothrow_compare &&
+                                               (std::is_nothrow_assignable<std::remove_reference_t<std::tuple_element_t<I, tie_t>>&,
+                                                                           typename assignable<std::remove_reference_t<std::tuple_element_t<I, tie_t>>>::type>::value && ...);
+  };
+
+  using traits_t = fields_traits<std::make_index_sequence<count_t::value>>;
+
+  static_assert(!std::is_const<T>::value,
+                "diff_saver requires not const type.");
+  static_assert(!std::is_rvalue_reference<U>::value && (std::is_lvalue_reference<U>::value || std::is_same<T, U>::value),
+                "diff_saver requires lvalue type.");
+  static_assert(std::is_aggregate<T>::value && !std::is_array<T>::value,
+                "diff_saver requires aggregate class type.");
+  static_assert(count_t::value > 0 && count_t::value <= max_fields_count,
+                "diff_saver requires aggregate with 1 to 32 fields.");
+  static_assert(std::is_constructible<T, T&>::value,
+                "diff_saver requires copy constructible.");
+  static_assert(is_policy<P>::value,
+                "diff_saver requires policy with explicit P(bool) noexcept, dismiss() noexcept and should_execute() const noexcept.");
+#if defined(STATE_SAVER_NO_THROW_RESTORE)
+  static_assert(traits_t::is_nothrow_restore,
+                "diff_saver requires noexcept operator= and operator== of fields.");
+#endif
+#if defined(STATE_SAVER_NO_THROW_CONSTRUCTIBLE)
+  static_assert(std::is_nothrow_constructible<T, T&>::value,
+                "diff_saver requires nothrow constructible.");
+#endif
+
+  P policy_;
+  T& previous_ref_;
+  T previous_value_;
+
+  template <std::size_t... I>
+  void copy_changed(std::index_sequence<I...>) {
+    auto current = tie_fields(previous_ref_, count_t{});
+    auto previous = tie_fields(previous_value_, count_t{});
+    (assign_if_changed(std::get<I>(current), std::get<I>(previous)), ...);
+  }
+
+  template <std::size_t... I>
+  void assign_changed(std::index_sequence<I...>) {
+    auto current = tie_fields(previous_ref_, count_t{});
+    auto previous = tie_fields(previous_value_, count_t{});
+    (assign_if_changed(std::get<I>(current), static_cast<typename assignable<std::remove_reference_t<std::tuple_element_t<I, tie_t>>>::type>(std::get<I>(previous))), ...);
+  }
+
+ public:
+  diff_saver() = delete;
+  diff_saver(const diff_saver&) = delete;
+  diff_saver(diff_saver&&) = delete;
+  diff_saver& operator=(const diff_saver&) = delete;
+  diff_saver& operator=(diff_saver&&) = delete;
+
+  diff_saver(T&&) = delete;
+  diff_saver(const T&) = delete;
+
+  explicit diff_saver(T& object) noexcept(std::is_nothrow_constructible<T, T&>::value)
+      : policy_{true},
+        previous_ref_{object},
+        previous_value_{object} {}
+
+  void dismiss() noexcept {
+    policy_.dismiss();
+  }
+
+  void restore() NEARGYE_NOEXCEPT(traits_t::is_nothrow_copy) {
+#if defined(STATE_SAVER_NO_THROW_RESTORE)
+    static_assert(traits_t::is_nothrow_copy, "diff_saver::restore requires noexcept copy operator= and operator== of fields.");
+#endif
+    NEARGYE_TRY
+      copy_changed(typename traits_t::sequence{});
+    NEARGYE_CATCH
+  }
+
+  ~diff_saver() NEARGYE_NOEXCEPT(traits_t::is_nothrow_restore) {
+    if (policy_.should_execute()) {
+      NEARGYE_TRY
+        assign_changed(typename traits_t::sequence{});
+      NEARGYE_CATCH
+    }
+  }
+};
+#endif
+
 #undef NEARGYE_NOEXCEPT
 #undef NEARGYE_TRY
 #undef NEARGYE_CATCH
 
 } // namespace state_saver::detail
 
+using on_exit_policy = detail::on_exit_policy;
+using on_fail_policy = detail::on_fail_policy;
+using on_success_policy = detail::on_success_policy;
+using inline_storage = detail::inline_storage;
+
+// Checks whether P satisfies the state_saver policy concept.
+template <typename P>
+struct is_saver_policy : detail::is_policy<P> {};
+
+// Checks whether S satisfies the state_saver storage concept for type T.
+template <typename S, typename T>
+struct is_saver_storage : detail::is_storage<S, T> {};
+
+// basic_saver saves the original variable value and restores on scope exit when the user-defined policy P allows it.
+template <typename U, typename P, typename S = inline_storage>
+class basic_saver : public detail::state_saver<U, P, S> {
+ public:
+  using detail::state_saver<U, P, S>::state_saver;
+};
+
+template <typename U, typename S = inline_storage>
+class saver_exit : public detail::state_saver<U, detail::on_exit_policy, S> {
+ public:
+  using detail::state_saver<U, detail::on_exit_policy, S>::state_saver;
+};
+
+template <typename U, typename S = inline_storage>
+class saver_fail : public detail::state_saver<U, detail::on_fail_policy, S> {
+ public:
+  using detail::state_saver<U, detail::on_fail_policy, S>::state_saver;
+};
+
+template <typename U, typename S = inline_storage>
+class saver_success : public detail::state_saver<U, detail::on_success_policy, S> {
+ public:
+  using detail::state_saver<U, detail::on_success_policy, S>::state_saver;
+};
+
+// saver_exit_bits saves the original masked bits of the integral or atomic integral variable and restores only them on scope exit.
+template <typename U>
+class saver_exit_bits : public detail::bits_saver<U, detail::on_exit_policy> {
+ public:
+  using detail::bits_saver<U, detail::on_exit_policy>::bits_saver;
+};
+
+// saver_fail_bits saves the original masked bits of the integral or atomic integral variable and restores only them on scope exit when an exception has been thrown.
+template <typename U>
+class saver_fail_bits : public detail::bits_saver<U, detail::on_fail_policy> {
+ public:
+  using detail::bits_saver<U, detail::on_fail_policy>::bits_saver;
+};
+
+// saver_success_bits saves the original masked bits of the integral or atomic integral variable and restores only them on scope exit when no exceptions have been thrown.
+template <typename U>
+class saver_success_bits : public detail::bits_saver<U, detail::on_success_policy> {
+ public:
+  using detail::bits_saver<U, detail::on_success_policy>::bits_saver;
+};
+
+// saver_exit_atomic saves the original value of the atomic variable and restores on scope exit.
+template <typename U>
+class saver_exit_atomic : public detail::atomic_saver<U, detail::on_exit_policy> {
+ public:
+  using detail::atomic_saver<U, detail::on_exit_policy>::atomic_saver;
+};
+
+// saver_fail_atomic saves the original value of the atomic variable and restores on scope exit when an exception has been thrown.
+template <typename U>
+class saver_fail_atomic : public detail::atomic_saver<U, detail::on_fail_policy> {
+ public:
+  using detail::atomic_saver<U, detail::on_fail_policy>::atomic_saver;
+};
+
+// saver_success_atomic saves the original value of the atomic variable and restores on scope exit when no exceptions have been thrown.
+template <typename U>
+class saver_success_atomic : public detail::atomic_saver<U, detail::on_success_policy> {
+ public:
+  using detail::atomic_saver<U, detail::on_success_policy>::atomic_saver;
+};
+
+#if defined(__cpp_nontype_template_parameter_auto) && __cpp_nontype_template_parameter_auto >= 201606L
+// saver_exit_fields saves only the selected fields of the object and restores them on scope exit.
+template <auto... Ms>
+class saver_exit_fields : public detail::fields_saver<detail::on_exit_policy, Ms...> {
+ public:
+  using detail::fields_saver<detail::on_exit_policy, Ms...>::fields_saver;
+};
+
+// saver_fail_fields saves only the selected fields of the object and restores them on scope exit when an exception has been thrown.
+template <auto... Ms>
+class saver_fail_fields : public detail::fields_saver<detail::on_fail_policy, Ms...> {
+ public:
+  using detail::fields_saver<detail::on_fail_policy, Ms...>::fields_saver;
+};
+
+// saver_success_fields saves only the selected fields of the object and restores them on scope exit when no exceptions have been thrown.
+template <auto... Ms>
+class saver_success_fields : public detail::fields_saver<detail::on_success_policy, Ms...> {
+ public:
+  using detail::fields_saver<detail::on_success_policy, Ms...>::fields_saver;
+};
+#endif
+
+#if defined(__cpp_structured_bindings) && __cpp_structured_bindings >= 201606L && defined(__cpp_lib_is_aggregate) && __cpp_lib_is_aggregate >= 201703L
+// saver_exit_diff saves the original aggregate value and on scope exit restores only fields that were changed.
 template <typename U>
-class saver_exit : public detail::state_saver<U, detail::on_exit_policy> {
+class saver_exit_diff : public detail::diff_saver<U, detail::on_exit_policy> {
  public:
-  using detail::state_saver<U, detail::on_exit_policy>::state_saver;
+  using detail::diff_saver<U, detail::on_exit_policy>::diff_saver;
 };
 
+// saver_fail_diff saves the original aggregate value and on scope exit restores only fields that were changed, when an exception has been thrown.
 template <typename U>
-class saver_fail : public detail::state_saver<U, detail::on_fail_policy> {
+class saver_fail_diff : public detail::diff_saver<U, detail::on_fail_policy> {
  public:
-  using detail::state_saver<U, detail::on_fail_policy>::state_saver;
+  using detail::diff_saver<U, detail::on_fail_policy>::diff_saver;
 };
 
+// saver_success_diff saves the original aggregate value and on scope exit restores only fields that were changed, when no exceptions have been thrown.
 template <typename U>
-class saver_success : public detail::state_saver<U, detail::on_success_policy> {
+class saver_success_diff : public detail::diff_saver<U, detail::on_success_policy> {
  public:
-  using detail::state_saver<U, detail::on_success_policy>::state_saver;
+  using detail::diff_saver<U, detail::on_success_policy>::diff_saver;
 };
 
+template <typename U>
+saver_exit_diff(U&) -> saver_exit_diff<U>;
+
+template <typename U>
+saver_fail_diff(U&) -> saver_fail_diff<U>;
+
+template <typename U>
+saver_success_diff(U&) -> saver_success_diff<U>;
+#endif
+
 #if defined(__cpp_deduction_guides) && __cpp_deduction_guides >= 201611L
 template <typename U>
 saver_exit(U&) -> saver_exit<U>;
@@ -257,6 +1098,24 @@ saver_fail(U&) -> saver_fail<U>;
 
 template <typename U>
 saver_success(U&) -> saver_success<U>;
+
+template <typename U, typename... Args>
+saver_exit_bits(U&, Args...) -> saver_exit_bits<U>;
+
+template <typename U, typename... Args>
+saver_fail_bits(U&, Args...) -> saver_fail_bits<U>;
+
+template <typename U, typename... Args>
+saver_success_bits(U&, Args...) -> saver_success_bits<U>;
+
+template <typename U, typename... Args>
+saver_exit_atomic(U&, Args...) -> saver_exit_atomic<U>;
+
+template <typename U, typename... Args>
+saver_fail_atomic(U&, Args...) -> saver_fail_atomic<U>;
+
+template <typename U, typename... Args>
+saver_success_atomic(U&, Args...) -> saver_success_atomic<U>;
 #endif
 
 } // namespace state_saver
@@ -300,10 +1159,10 @@ saver_success(U&) -> saver_success<U>;
 #endif
 
 #if __cplusplus >= 201703L || defined(_MSVC_LANG) && _MSVC_LANG >= 201703L
-#  define NEARGYE_STATE_SAVER_WITH(s) if (s; true)
+#  define NEARGYE_STATE_SAVER_WITH(...) if (__VA_ARGS__; true)
 #else
-#  define NEARGYE_STATE_SAVER_WITH_IMPL(s, i) if (int i = 1) for (s; i; --i)
-#  define NEARGYE_STATE_SAVER_WITH(s) NEARGYE_STATE_SAVER_WITH_IMPL(s, NEARGYE_STR_CONCAT(WITH_INTERNAL_OBJECT_, NEARGYE_COUNTER))
+#  define NEARGYE_STATE_SAVER_WITH_IMPL(i, ...) if (int i = 1) for (__VA_ARGS__; i; --i)
+#  define NEARGYE_STATE_SAVER_WITH(...) NEARGYE_STATE_SAVER_WITH_IMPL(NEARGYE_STR_CONCAT(WITH_INTERNAL_OBJECT_, NEARGYE_COUNTER), __VA_ARGS__)
 #endif
 
 // SAVER_EXIT saves the original variable value and restores on scope exit.
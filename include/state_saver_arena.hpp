@@ -0,0 +1,264 @@
+//   _____ _        _          _____                         _____
+//  / ____| |      | |        / ____|                       / ____|_     _
+// | (___ | |_ __ _| |_ ___  | (___   __ ___   _____ _ __  | |   _| |_ _| |_
+//  \___ \| __/ _` | __/ _ \  \___ \ / _` \ \ / / _ \ '__| | |  |_   _|_   _|
+//  ____) | || (_| | ||  __/  ____) | (_| |\ V /  __/ |    | |____|_|   |_|
+// |_____/ \__\__,_|\__\___| |_____/ \__,_| \_/ \___|_|     \_____|
+// https://github.com/Neargye/state_saver
+// version 0.9.0
+//
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NEARGYE_STATE_SAVER_ARENA_HPP
+#define NEARGYE_STATE_SAVER_ARENA_HPP
+
+#include "state_saver.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+#if defined(__linux__)
+#  include <sys/mman.h>
+#endif
+
+#if !defined(STATE_SAVER_ARENA_CHUNK_SIZE)
+#  define STATE_SAVER_ARENA_CHUNK_SIZE (64 * 1024)
+#endif
+
+namespace state_saver {
+
+namespace detail {
+
+// Thread-local stack of chunks, allocation and free are a pointer bump because savers are destroyed in reverse order.
+// Block freed out of order is marked and popped together with the block above it.
+class snapshot_arena {
+  static constexpr std::size_t align = alignof(std::max_align_t);
+  static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+  static constexpr std::size_t max_chunk_size = std::size_t{16} << 20;
+  static constexpr std::size_t huge_page_size = std::size_t{2} << 20;
+
+  struct chunk {
+    chunk* prev;
+    std::size_t capacity;
+    std::size_t top;
+    std::size_t last;
+    bool mapped;
+  };
+
+  struct block {
+    std::size_t prev;
+    bool freed;
+  };
+
+  static constexpr std::size_t aligned(std::size_t size) noexcept {
+    return (size + align - 1) / align * align;
+  }
+
+  static constexpr std::size_t chunk_header = (sizeof(chunk) + align - 1) / align * align;
+  static constexpr std::size_t block_header = (sizeof(block) + align - 1) / align * align;
+
+  chunk* current_;
+  chunk* spare_;
+
+  static unsigned char* data(chunk* c) noexcept {
+    return reinterpret_cast<unsigned char*>(c) + chunk_header;
+  }
+
+  static block* at(chunk* c, std::size_t offset) noexcept {
+    return reinterpret_cast<block*>(data(c) + offset);
+  }
+
+  // Big chunks are mapped directly and backed by transparent huge pages where available.
+  static chunk* new_chunk(std::size_t capacity) {
+    const std::size_t size = chunk_header + capacity;
+    void* p = nullptr;
+    bool mapped = false;
+#if defined(__linux__)
+    if (size >= huge_page_size) {
+      p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (p == MAP_FAILED) {
+        throw std::bad_alloc{};
+      }
+#  if defined(MADV_HUGEPAGE)
+      ::madvise(p, size, MADV_HUGEPAGE);
+#  endif
+      mapped = true;
+    }
+#endif
+    if (p == nullptr) {
+      p = ::operator new(size);
+    }
+    return ::new (p) chunk{nullptr, capacity, 0, npos, mapped};
+  }
+
+  static void delete_chunk(chunk* c) noexcept {
+    if (c == nullptr) {
+      return;
+    }
+#if defined(__linux__)
+    if (c->mapped) {
+      ::munmap(c, chunk_header + c->capacity);
+      return;
+    }
+#endif
+    ::operator delete(c);
+  }
+
+  void push_chunk(std::size_t required) {
+    if (spare_ != nullptr && spare_->capacity >= required) {
+      spare_->prev = current_;
+      current_ = spare_;
+      spare_ = nullptr;
+      return;
+    }
+    std::size_t capacity = current_ == nullptr ? STATE_SAVER_ARENA_CHUNK_SIZE : current_->capacity * 2;
+    capacity = capacity > max_chunk_size ? max_chunk_size : capacity;
+    capacity = capacity < required ? aligned(required) : capacity;
+    chunk* c = new_chunk(capacity);
+    c->prev = current_;
+    current_ = c;
+  }
+
+  // Pops freed blocks from the top, empty chunk is kept as spare.
+  void pop() noexcept {
+    while (current_ != nullptr) {
+      if (current_->last == npos) {
+        if (current_->prev == nullptr) {
+          return;
+        }
+        chunk* c = current_;
+        current_ = c->prev;
+        delete_chunk(spare_);
+        spare_ = c;
+        continue;
+      }
+      block* b = at(current_, current_->last);
+      if (!b->freed) {
+        return;
+      }
+      current_->top = current_->last;
+      current_->last = b->prev;
+    }
+  }
+
+ public:
+  snapshot_arena(const snapshot_arena&) = delete;
+  snapshot_arena& operator=(const snapshot_arena&) = delete;
+
+  snapshot_arena() noexcept : current_{nullptr}, spare_{nullptr} {}
+
+  static snapshot_arena& local() noexcept {
+    static thread_local snapshot_arena arena;
+    return arena;
+  }
+
+  void* allocate(std::size_t size) {
+    const std::size_t required = block_header + aligned(size);
+    if (current_ == nullptr || current_->capacity - current_->top < required) {
+      push_chunk(required);
+    }
+    const std::size_t offset = current_->top;
+    ::new (data(current_) + offset) block{current_->last, false};
+    current_->last = offset;
+    current_->top = offset + required;
+    return data(current_) + offset + block_header;
+  }
+
+  // Must be called on the thread which allocated p.
+  void deallocate(void* p) noexcept {
+    reinterpret_cast<block*>(static_cast<unsigned char*>(p) - block_header)->freed = true;
+    pop();
+  }
+
+  // Bytes in use in the current chunk, for diagnostics.
+  std::size_t used() const noexcept {
+    return current_ == nullptr ? 0 : current_->top;
+  }
+
+  ~snapshot_arena() noexcept {
+    while (current_ != nullptr) {
+      chunk* c = current_;
+      current_ = c->prev;
+      delete_chunk(c);
+    }
+    delete_chunk(spare_);
+  }
+};
+
+// Keeps snapshot in the thread-local arena, the saver holds only a pointer.
+template <typename T>
+class arena_snapshot {
+  using assignable_t = typename assignable<T>::type;
+
+  static_assert(alignof(T) <= alignof(std::max_align_t),
+                "arena_storage requires type with alignment not greater than std::max_align_t.");
+
+  T* value_;
+
+ public:
+  arena_snapshot(const arena_snapshot&) = delete;
+  arena_snapshot& operator=(const arena_snapshot&) = delete;
+
+  explicit arena_snapshot(T& object) : value_{nullptr} {
+    void* p = snapshot_arena::local().allocate(sizeof(T));
+    try {
+      value_ = ::new (p) T(object);
+    } catch (...) {
+      snapshot_arena::local().deallocate(p);
+      throw;
+    }
+  }
+
+  void copy_to(T& object) noexcept(std::is_nothrow_assignable<T&, T&>::value) {
+    object = *value_;
+  }
+
+  void move_to(T& object) noexcept(std::is_nothrow_assignable<T&, assignable_t>::value) {
+    object = static_cast<assignable_t>(*value_);
+  }
+
+  ~arena_snapshot() noexcept {
+    value_->~T();
+    snapshot_arena::local().deallocate(value_);
+  }
+};
+
+} // namespace state_saver::detail
+
+// Keeps snapshots of types with size not greater than Threshold bytes inline, larger ones are allocated in the thread-local arena.
+// Saver must be destroyed on the thread which created it.
+template <std::size_t Threshold>
+struct basic_arena_storage {
+  template <typename T>
+  using snapshot = typename std::conditional<(sizeof(T) <= Threshold),
+                                             inline_storage::snapshot<T>,
+                                             detail::arena_snapshot<T>>::type;
+};
+
+using arena_storage = basic_arena_storage<256>;
+
+} // namespace state_saver
+
+#endif // NEARGYE_STATE_SAVER_ARENA_HPP
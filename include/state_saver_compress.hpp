@@ -0,0 +1,216 @@
+//   _____ _        _          _____                         _____
+//  / ____| |      | |        / ____|                       / ____|_     _
+// | (___ | |_ __ _| |_ ___  | (___   __ ___   _____ _ __  | |   _| |_ _| |_
+//  \___ \| __/ _` | __/ _ \  \___ \ / _` \ \ / / _ \ '__| | |  |_   _|_   _|
+//  ____) | || (_| | ||  __/  ____) | (_| |\ V /  __/ |    | |____|_|   |_|
+// |_____/ \__\__,_|\__\___| |_____/ \__,_| \_/ \___|_|     \_____|
+// https://github.com/Neargye/state_saver
+// version 0.9.0
+//
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NEARGYE_STATE_SAVER_COMPRESS_HPP
+#define NEARGYE_STATE_SAVER_COMPRESS_HPP
+
+#include "state_saver.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace state_saver {
+
+namespace detail {
+
+// Block codec, sequence of tokens:
+// * 0x00-0x7F - literal run, (token + 1) bytes follow.
+// * 0x80-0xBF - byte run of (token - 0x80 + 4) copies of the next byte.
+// * 0xC0-0xFF - match of (token - 0xC0 + 4) bytes at 16-bit little endian distance that follows.
+constexpr std::size_t codec_min_match = 4;
+constexpr std::size_t codec_max_match = 0x3F + codec_min_match;
+constexpr std::size_t codec_max_literal = 0x80;
+constexpr std::size_t codec_max_distance = 0xFFFF;
+constexpr std::size_t codec_hash_bits = 12;
+
+inline std::size_t codec_bound(std::size_t size) noexcept {
+  return size + size / codec_max_literal + 1;
+}
+
+inline std::uint32_t codec_hash(const unsigned char* p) noexcept {
+  std::uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return (v * 2654435761U) >> (32 - codec_hash_bits);
+}
+
+inline void codec_flush_literals(const unsigned char* literal, const unsigned char* end, std::vector<unsigned char>& out) {
+  while (literal < end) {
+    const std::size_t count = static_cast<std::size_t>(end - literal) < codec_max_literal ? static_cast<std::size_t>(end - literal) : codec_max_literal;
+    out.push_back(static_cast<unsigned char>(count - 1));
+    out.insert(out.end(), literal, literal + count);
+    literal += count;
+  }
+}
+
+// Greedy compression, returns false if the output would not be smaller than the input.
+inline bool compress(const unsigned char* data, std::size_t size, std::vector<unsigned char>& out) {
+  out.clear();
+  out.reserve(codec_bound(size));
+  std::vector<std::uint32_t> table(std::size_t{1} << codec_hash_bits, 0);
+  const unsigned char* const begin = data;
+  const unsigned char* const end = data + size;
+  const unsigned char* literal = data;
+  const unsigned char* p = data;
+
+  while (p + codec_min_match <= end) {
+    std::size_t run = 1;
+    while (p + run < end && run < codec_max_match && p[run] == p[0]) {
+      ++run;
+    }
+    if (run >= codec_min_match) {
+      codec_flush_literals(literal, p, out);
+      out.push_back(static_cast<unsigned char>(0x80 + run - codec_min_match));
+      out.push_back(p[0]);
+      p += run;
+      literal = p;
+      continue;
+    }
+
+    const std::uint32_t h = codec_hash(p);
+    const unsigned char* candidate = begin + table[h];
+    table[h] = static_cast<std::uint32_t>(p - begin);
+    const std::size_t distance = static_cast<std::size_t>(p - candidate);
+    if (distance != 0 && distance <= codec_max_distance && std::memcmp(candidate, p, codec_min_match) == 0) {
+      std::size_t length = codec_min_match;
+      while (p + length < end && length < codec_max_match && candidate[length] == p[length]) {
+        ++length;
+      }
+      codec_flush_literals(literal, p, out);
+      out.push_back(static_cast<unsigned char>(0xC0 + length - codec_min_match));
+      out.push_back(static_cast<unsigned char>(distance & 0xFF));
+      out.push_back(static_cast<unsigned char>(distance >> 8));
+      p += length;
+      literal = p;
+      continue;
+    }
+    ++p;
+    if (out.size() >= size) {
+      return false;
+    }
+  }
+  codec_flush_literals(literal, end, out);
+  return out.size() < size;
+}
+
+// Decompresses exactly size bytes, returns false on malformed input.
+inline bool decompress(const unsigned char* in, std::size_t in_size, unsigned char* data, std::size_t size) noexcept {
+  const unsigned char* const in_end = in + in_size;
+  std::size_t pos = 0;
+  while (in < in_end) {
+    const std::size_t token = *in++;
+    if (token < 0x80) {
+      const std::size_t count = token + 1;
+      if (count > static_cast<std::size_t>(in_end - in) || count > size - pos) {
+        return false;
+      }
+      std::memcpy(data + pos, in, count);
+      in += count;
+      pos += count;
+    } else if (token < 0xC0) {
+      const std::size_t count = token - 0x80 + codec_min_match;
+      if (in == in_end || count > size - pos) {
+        return false;
+      }
+      std::memset(data + pos, *in++, count);
+      pos += count;
+    } else {
+      const std::size_t count = token - 0xC0 + codec_min_match;
+      if (in_end - in < 2) {
+        return false;
+      }
+      const std::size_t distance = static_cast<std::size_t>(in[0]) | (static_cast<std::size_t>(in[1]) << 8);
+      in += 2;
+      if (distance == 0 || distance > pos || count > size - pos) {
+        return false;
+      }
+      for (std::size_t i = 0; i < count; ++i, ++pos) {
+        data[pos] = data[pos - distance]; // Overlapping copy.
+      }
+    }
+  }
+  return pos == size;
+}
+
+// Keeps snapshot of trivially copyable type compressed, it is decompressed only on restore.
+// C arrays are rejected by state_saver, wrap them in a struct or std::array.
+template <typename T>
+class compressed_snapshot {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "compressed_storage requires trivially copyable type.");
+
+  std::vector<unsigned char> bytes_;
+  bool compressed_;
+
+ public:
+  explicit compressed_snapshot(T& object) : bytes_{}, compressed_{false} {
+    const auto* data = reinterpret_cast<const unsigned char*>(std::addressof(object));
+    compressed_ = compress(data, sizeof(T), bytes_);
+    if (!compressed_) {
+      bytes_.assign(data, data + sizeof(T)); // Incompressible, keep as is.
+    }
+    bytes_.shrink_to_fit();
+  }
+
+  // Throws std::runtime_error if the compressed bytes are malformed, the object is left partially written.
+  void copy_to(T& object) {
+    auto* data = reinterpret_cast<unsigned char*>(std::addressof(object));
+    if (!compressed_) {
+      std::memcpy(data, bytes_.data(), sizeof(T));
+    } else if (!decompress(bytes_.data(), bytes_.size(), data, sizeof(T))) {
+      throw std::runtime_error{"compressed_storage: malformed snapshot."};
+    }
+  }
+
+  void move_to(T& object) {
+    copy_to(object);
+  }
+};
+
+} // namespace state_saver::detail
+
+// Compresses snapshots of types with size not less than Threshold bytes, smaller ones are kept inline.
+template <std::size_t Threshold>
+struct basic_compressed_storage {
+  template <typename T>
+  using snapshot = typename std::conditional<(sizeof(T) < Threshold),
+                                             inline_storage::snapshot<T>,
+                                             detail::compressed_snapshot<T>>::type;
+};
+
+using compressed_storage = basic_compressed_storage<256>;
+
+} // namespace state_saver
+
+#endif // NEARGYE_STATE_SAVER_COMPRESS_HPP
@@ -0,0 +1,248 @@
+//   _____ _        _          _____                         _____
+//  / ____| |      | |        / ____|                       / ____|_     _
+// | (___ | |_ __ _| |_ ___  | (___   __ ___   _____ _ __  | |   _| |_ _| |_
+//  \___ \| __/ _` | __/ _ \  \___ \ / _` \ \ / / _ \ '__| | |  |_   _|_   _|
+//  ____) | || (_| | ||  __/  ____) | (_| |\ V /  __/ |    | |____|_|   |_|
+// |_____/ \__\__,_|\__\___| |_____/ \__,_| \_/ \___|_|     \_____|
+// https://github.com/Neargye/state_saver
+// version 0.9.0
+//
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NEARGYE_STATE_SAVER_CORO_HPP
+#define NEARGYE_STATE_SAVER_CORO_HPP
+
+#include "state_saver.hpp"
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L && defined(__has_include)
+#if __has_include(<coroutine>)
+#define NEARGYE_STATE_SAVER_CORO 1
+#endif
+#endif
+
+#if defined(NEARGYE_STATE_SAVER_CORO)
+
+#include <coroutine>
+#include <type_traits>
+#include <utility>
+
+namespace state_saver {
+
+// Tag for coroutine savers, which undo the override around each suspension and re-apply it on resume.
+struct coro_scoped_t {
+  explicit coro_scoped_t() = default;
+};
+
+inline constexpr coro_scoped_t coro_scoped{};
+
+namespace detail {
+
+// Whether coroutine destroyed while suspended restores the object, coroutine that never completed is treated as failed.
+template <typename P>
+struct is_restore_on_cancel : std::true_type {};
+
+template <>
+struct is_restore_on_cancel<on_success_policy> : std::false_type {};
+
+template <typename A>
+decltype(auto) get_awaiter(A&& awaitable) {
+  if constexpr (requires { static_cast<A&&>(awaitable).operator co_await(); }) {
+    return static_cast<A&&>(awaitable).operator co_await();
+  } else if constexpr (requires { operator co_await(static_cast<A&&>(awaitable)); }) {
+    return operator co_await(static_cast<A&&>(awaitable));
+  } else {
+    return static_cast<A&&>(awaitable);
+  }
+}
+
+// The policy is constructed again on each resume, so uncaught exceptions are counted on the thread which runs the coroutine.
+template <typename U, typename P>
+class coro_saver {
+  using T = typename std::remove_reference<U>::type;
+
+  static_assert(!std::is_const<T>::value,
+                "coro_saver requires not const type.");
+  static_assert(!std::is_rvalue_reference<U>::value && (std::is_lvalue_reference<U>::value || std::is_same<T, U>::value),
+                "coro_saver requires lvalue type.");
+  static_assert(std::is_constructible<T, T&>::value,
+                "coro_saver requires copy constructible.");
+  static_assert(std::is_assignable<T&, typename assignable<T>::type>::value,
+                "coro_saver requires operator=.");
+  static_assert(std::is_swappable<T>::value,
+                "coro_saver requires swappable type.");
+  static_assert(is_policy<P>::value && std::is_move_assignable<P>::value,
+                "coro_saver requires move assignable policy with explicit P(bool) noexcept, dismiss() noexcept and should_execute() const noexcept.");
+#if defined(STATE_SAVER_NO_THROW_RESTORE)
+  static_assert(std::is_nothrow_assignable<T&, typename assignable<T>::type>::value,
+                "coro_saver requires noexcept operator=.");
+#endif
+#if defined(STATE_SAVER_NO_THROW_CONSTRUCTIBLE)
+  static_assert(std::is_nothrow_constructible<T, T&>::value,
+                "coro_saver requires nothrow constructible.");
+#endif
+
+  using assignable_t = typename assignable<T>::type;
+
+  P policy_;
+  T& previous_ref_;
+  T previous_value_;
+  bool scoped_;
+  bool dismissed_ = false;
+  bool suspended_ = false;
+
+  template <typename A>
+  class around_awaiter {
+    coro_saver& saver_;
+    A awaiter_;
+
+   public:
+    around_awaiter(coro_saver& saver, A&& awaiter) : saver_{saver}, awaiter_(static_cast<A&&>(awaiter)) {}
+
+    bool await_ready() {
+      return awaiter_.await_ready();
+    }
+
+    template <typename Promise>
+    decltype(auto) await_suspend(std::coroutine_handle<Promise> handle) {
+      // Saver must not be touched after await_suspend of awaiter, the coroutine may already be resumed on other thread.
+      saver_.suspend();
+      return awaiter_.await_suspend(handle);
+    }
+
+    decltype(auto) await_resume() {
+      saver_.resume();
+      return awaiter_.await_resume();
+    }
+  };
+
+  void suspend() {
+    if (scoped_) {
+      using std::swap;
+      swap(previous_ref_, previous_value_);
+    }
+    suspended_ = true;
+  }
+
+  void resume() {
+    if (!suspended_) {
+      return;
+    }
+    suspended_ = false;
+    policy_ = P{!dismissed_};
+    if (scoped_) {
+      using std::swap;
+      swap(previous_ref_, previous_value_);
+    }
+  }
+
+ public:
+  coro_saver() = delete;
+  coro_saver(const coro_saver&) = delete;
+  coro_saver(coro_saver&&) = delete;
+  coro_saver& operator=(const coro_saver&) = delete;
+  coro_saver& operator=(coro_saver&&) = delete;
+
+  coro_saver(T&&) = delete;
+  coro_saver(const T&) = delete;
+
+  explicit coro_saver(T& object) noexcept(std::is_nothrow_constructible<T, T&>::value)
+      : policy_{true},
+        previous_ref_{object},
+        previous_value_{object},
+        scoped_{false} {}
+
+  // Override is visible only while the coroutine runs, it is undone around each suspension made through around().
+  coro_saver(T& object, coro_scoped_t) noexcept(std::is_nothrow_constructible<T, T&>::value)
+      : policy_{true},
+        previous_ref_{object},
+        previous_value_{object},
+        scoped_{true} {}
+
+  // Wraps awaitable, so that saver is notified about suspension and resumption: co_await saver.around(awaitable).
+  template <typename A>
+  auto around(A&& awaitable) {
+    using awaiter_t = decltype(get_awaiter(static_cast<A&&>(awaitable)));
+    return around_awaiter<awaiter_t>{*this, get_awaiter(static_cast<A&&>(awaitable))};
+  }
+
+  void dismiss() noexcept {
+    policy_.dismiss();
+    dismissed_ = true;
+  }
+
+  void restore() noexcept(is_noexcept_restore<std::is_nothrow_assignable<T&, T&>::value>::value) {
+#if defined(STATE_SAVER_NO_THROW_RESTORE)
+    static_assert(std::is_nothrow_assignable<T&, T&>::value, "coro_saver::restore requires noexcept copy operator=.");
+#endif
+    invoke_restore([this]() { previous_ref_ = previous_value_; });
+  }
+
+  ~coro_saver() noexcept(is_noexcept_restore<std::is_nothrow_assignable<T&, assignable_t>::value>::value) {
+    if (suspended_) {
+      // Destroyed while suspended, in scoped mode the object already holds the original value.
+      if (!scoped_ && !dismissed_ && is_restore_on_cancel<P>::value) {
+        invoke_restore([this]() { previous_ref_ = static_cast<assignable_t>(previous_value_); });
+      }
+    } else if (policy_.should_execute()) {
+      invoke_restore([this]() { previous_ref_ = static_cast<assignable_t>(previous_value_); });
+    }
+  }
+};
+
+} // namespace state_saver::detail
+
+// saver_exit_coro saves the original variable value and restores on coroutine scope exit.
+template <typename U>
+class saver_exit_coro : public detail::coro_saver<U, detail::on_exit_policy> {
+ public:
+  using detail::coro_saver<U, detail::on_exit_policy>::coro_saver;
+};
+
+// saver_fail_coro saves the original variable value and restores on coroutine scope exit when an exception has been thrown in the coroutine.
+template <typename U>
+class saver_fail_coro : public detail::coro_saver<U, detail::on_fail_policy> {
+ public:
+  using detail::coro_saver<U, detail::on_fail_policy>::coro_saver;
+};
+
+// saver_success_coro saves the original variable value and restores on coroutine scope exit when no exceptions have been thrown in the coroutine.
+template <typename U>
+class saver_success_coro : public detail::coro_saver<U, detail::on_success_policy> {
+ public:
+  using detail::coro_saver<U, detail::on_success_policy>::coro_saver;
+};
+
+template <typename U, typename... Args>
+saver_exit_coro(U&, Args...) -> saver_exit_coro<U>;
+
+template <typename U, typename... Args>
+saver_fail_coro(U&, Args...) -> saver_fail_coro<U>;
+
+template <typename U, typename... Args>
+saver_success_coro(U&, Args...) -> saver_success_coro<U>;
+
+} // namespace state_saver
+
+#endif // NEARGYE_STATE_SAVER_CORO
+
+#endif // NEARGYE_STATE_SAVER_CORO_HPP
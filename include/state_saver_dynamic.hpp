@@ -0,0 +1,352 @@
+//   _____ _        _          _____                         _____
+//  / ____| |      | |        / ____|                       / ____|_     _
+// | (___ | |_ __ _| |_ ___  | (___   __ ___   _____ _ __  | |   _| |_ _| |_
+//  \___ \| __/ _` | __/ _ \  \___ \ / _` \ \ / / _ \ '__| | |  |_   _|_   _|
+//  ____) | || (_| | ||  __/  ____) | (_| |\ V /  __/ |    | |____|_|   |_|
+// |_____/ \__\__,_|\__\___| |_____/ \__,_| \_/ \___|_|     \_____|
+// https://github.com/Neargye/state_saver
+// version 0.9.0
+//
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NEARGYE_STATE_SAVER_DYNAMIC_HPP
+#define NEARGYE_STATE_SAVER_DYNAMIC_HPP
+
+#include "state_saver.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace state_saver {
+
+namespace detail {
+
+// Frame of the thread-local stack of dynamic variable overrides.
+struct dynamic_frame {
+  const void* var;
+  const void* value;
+  dynamic_frame* prev;
+  // Shares the override value for capture into dynamic_context.
+  std::shared_ptr<const void> (*share)(const dynamic_frame&);
+  // Owner of the value, if the frame was applied from dynamic_context.
+  const std::shared_ptr<const void>* shared;
+  // Slot of the variable in the thread-local bindings.
+  std::size_t slot;
+  // Previous binding of the same variable, restored when the frame is unbound.
+  dynamic_frame* shadowed;
+};
+
+template <typename T>
+std::shared_ptr<const void> share_dynamic_value(const dynamic_frame& frame) {
+  return std::make_shared<const T>(*static_cast<const T*>(frame.value));
+}
+
+inline dynamic_frame*& dynamic_top() noexcept {
+  static thread_local dynamic_frame* top = nullptr;
+  return top;
+}
+
+// Innermost override of each variable on the thread, indexed by slot of the variable.
+// Trivial type, so read of it is one thread-local access without initialization guard.
+struct dynamic_bindings {
+  dynamic_frame** frames;
+  std::size_t size;
+};
+
+inline dynamic_bindings& dynamic_current() noexcept {
+  static thread_local dynamic_bindings bindings = {nullptr, 0};
+  return bindings;
+}
+
+// Frees the bindings on thread exit.
+class dynamic_bindings_owner {
+  std::unique_ptr<dynamic_frame*[]> frames_;
+
+ public:
+  void reset(std::unique_ptr<dynamic_frame*[]> frames) noexcept {
+    frames_ = std::move(frames);
+  }
+
+  ~dynamic_bindings_owner() noexcept {
+    dynamic_current() = dynamic_bindings{nullptr, 0};
+  }
+};
+
+// Slots are not reused, bindings of a thread take one pointer per variable overridden in it.
+inline std::size_t dynamic_next_slot() noexcept {
+  static std::atomic<std::size_t> next{0};
+  return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline void dynamic_reserve(std::size_t slot) {
+  dynamic_bindings& bindings = dynamic_current();
+  if (slot < bindings.size) {
+    return;
+  }
+  std::size_t size = bindings.size == 0 ? 16 : bindings.size * 2;
+  while (size <= slot) {
+    size *= 2;
+  }
+  std::unique_ptr<dynamic_frame*[]> frames{new dynamic_frame*[size]()};
+  if (bindings.size != 0) {
+    std::memcpy(frames.get(), bindings.frames, bindings.size * sizeof(dynamic_frame*));
+  }
+  static thread_local dynamic_bindings_owner owner;
+  bindings = dynamic_bindings{frames.get(), size};
+  owner.reset(std::move(frames));
+}
+
+// Slot of the frame must be reserved.
+inline void dynamic_bind(dynamic_frame& frame) noexcept {
+  dynamic_frame*& current = dynamic_current().frames[frame.slot];
+  frame.shadowed = current;
+  current = &frame;
+}
+
+inline void dynamic_unbind(dynamic_frame& frame) noexcept {
+  dynamic_current().frames[frame.slot] = frame.shadowed;
+}
+
+// Unbinds all frames of the stack, used when fiber is switched out.
+inline void dynamic_unbind_stack(dynamic_frame* top) noexcept {
+  for (dynamic_frame* frame = top; frame != nullptr; frame = frame->prev) {
+    dynamic_unbind(*frame);
+  }
+}
+
+// Binds frames of the stack unbound by dynamic_unbind_stack, innermost frame of each variable wins.
+inline void dynamic_bind_stack(dynamic_frame* top) noexcept {
+  for (dynamic_frame* frame = top; frame != nullptr; frame = frame->prev) {
+    dynamic_frame*& current = dynamic_current().frames[frame->slot];
+    if (current == nullptr) {
+      current = frame;
+    }
+  }
+}
+
+} // namespace state_saver::detail
+
+// dynamic_var is global variable with thread-local dynamically scoped overrides.
+// Read is one TLS load of the innermost override of the variable, with fall back to the global value.
+template <typename T>
+class dynamic_var {
+  static_assert(!std::is_reference<T>::value && !std::is_const<T>::value,
+                "dynamic_var requires not const and not reference type.");
+
+  T global_;
+  std::size_t slot_;
+
+  template <typename U>
+  friend class saver_dynamic;
+
+ public:
+  using value_type = T;
+
+  dynamic_var() noexcept(std::is_nothrow_default_constructible<T>::value) : global_(), slot_{detail::dynamic_next_slot()} {}
+
+  explicit dynamic_var(T value) noexcept(std::is_nothrow_move_constructible<T>::value) : global_(std::move(value)), slot_{detail::dynamic_next_slot()} {}
+
+  dynamic_var(const dynamic_var&) = delete;
+  dynamic_var(dynamic_var&&) = delete;
+  dynamic_var& operator=(const dynamic_var&) = delete;
+  dynamic_var& operator=(dynamic_var&&) = delete;
+
+  // Returns the innermost override of the current thread, or the global value.
+  const T& get() const noexcept {
+    const detail::dynamic_bindings& bindings = detail::dynamic_current();
+    if (slot_ < bindings.size && bindings.frames[slot_] != nullptr) {
+      return *static_cast<const T*>(bindings.frames[slot_]->value);
+    }
+    return global_;
+  }
+
+  operator const T&() const noexcept {
+    return get();
+  }
+
+  // Global value, visible to threads without overrides. Access is not synchronized.
+  T& global() noexcept {
+    return global_;
+  }
+
+  const T& global() const noexcept {
+    return global_;
+  }
+};
+
+// saver_dynamic overrides dynamic_var for the current thread until scope exit.
+template <typename T>
+class saver_dynamic {
+  T value_;
+  detail::dynamic_frame frame_;
+
+ public:
+  saver_dynamic() = delete;
+  saver_dynamic(const saver_dynamic&) = delete;
+  saver_dynamic(saver_dynamic&&) = delete;
+  saver_dynamic& operator=(const saver_dynamic&) = delete;
+  saver_dynamic& operator=(saver_dynamic&&) = delete;
+
+  // Throws std::bad_alloc if bindings of the thread have to grow for the variable.
+  template <typename V>
+  saver_dynamic(dynamic_var<T>& var, V&& value)
+      : value_(std::forward<V>(value)),
+        frame_{&var, &value_, detail::dynamic_top(), &detail::share_dynamic_value<T>, nullptr, var.slot_, nullptr} {
+    detail::dynamic_reserve(frame_.slot);
+    detail::dynamic_bind(frame_);
+    detail::dynamic_top() = &frame_;
+  }
+
+  // Value of the override.
+  T& value() noexcept {
+    return value_;
+  }
+
+  const T& value() const noexcept {
+    return value_;
+  }
+
+  ~saver_dynamic() noexcept {
+    detail::dynamic_unbind(frame_);
+    detail::dynamic_top() = frame_.prev;
+  }
+};
+
+// dynamic_context is a snapshot of the dynamic variable overrides active in a thread.
+// Copy is one shared pointer copy, so it can be cheaply passed to tasks of thread pool.
+class dynamic_context {
+  struct binding {
+    const void* var;
+    std::size_t slot;
+    std::shared_ptr<const void> value;
+  };
+
+  // Innermost override first.
+  std::shared_ptr<const std::vector<binding>> bindings_;
+
+  friend dynamic_context capture_dynamic_context();
+  friend class saver_dynamic_context;
+
+ public:
+  dynamic_context() = default;
+
+  bool empty() const noexcept {
+    return bindings_ == nullptr || bindings_->empty();
+  }
+
+  std::size_t size() const noexcept {
+    return bindings_ == nullptr ? 0 : bindings_->size();
+  }
+};
+
+// Captures overrides active in the current thread, cost is proportional to the number of active overrides.
+// Shadowed overrides are skipped, values applied from other context are shared without copy.
+inline dynamic_context capture_dynamic_context() {
+  dynamic_context context;
+  const detail::dynamic_frame* top = detail::dynamic_top();
+  if (top == nullptr) {
+    return context;
+  }
+
+  auto bindings = std::make_shared<std::vector<dynamic_context::binding>>();
+  const detail::dynamic_bindings& current = detail::dynamic_current();
+  for (const detail::dynamic_frame* frame = top; frame != nullptr; frame = frame->prev) {
+    if (current.frames[frame->slot] == frame) {
+      bindings->push_back(dynamic_context::binding{frame->var, frame->slot, frame->share(*frame)});
+    }
+  }
+  context.bindings_ = std::move(bindings);
+
+  return context;
+}
+
+// saver_dynamic_context applies captured overrides to the current thread until scope exit.
+class saver_dynamic_context {
+  dynamic_context context_;
+  std::vector<detail::dynamic_frame> frames_;
+  detail::dynamic_frame* prev_;
+
+ public:
+  saver_dynamic_context() = delete;
+  saver_dynamic_context(const saver_dynamic_context&) = delete;
+  saver_dynamic_context(saver_dynamic_context&&) = delete;
+  saver_dynamic_context& operator=(const saver_dynamic_context&) = delete;
+  saver_dynamic_context& operator=(saver_dynamic_context&&) = delete;
+
+  explicit saver_dynamic_context(dynamic_context context)
+      : context_(std::move(context)),
+        frames_{},
+        prev_{detail::dynamic_top()} {
+    if (context_.empty()) {
+      return;
+    }
+
+    const auto& bindings = *context_.bindings_;
+    frames_.resize(bindings.size());
+    for (std::size_t i = 0; i < bindings.size(); ++i) {
+      frames_[i].var = bindings[i].var;
+      frames_[i].value = bindings[i].value.get();
+      frames_[i].prev = i + 1 < bindings.size() ? &frames_[i + 1] : prev_;
+      frames_[i].share = &share_binding;
+      frames_[i].shared = &bindings[i].value;
+      frames_[i].slot = bindings[i].slot;
+      frames_[i].shadowed = nullptr;
+      detail::dynamic_reserve(bindings[i].slot);
+    }
+    for (auto it = frames_.rbegin(); it != frames_.rend(); ++it) {
+      detail::dynamic_bind(*it);
+    }
+    detail::dynamic_top() = &frames_.front();
+  }
+
+  ~saver_dynamic_context() noexcept {
+    for (auto& frame : frames_) {
+      detail::dynamic_unbind(frame);
+    }
+    detail::dynamic_top() = prev_;
+  }
+
+ private:
+  static std::shared_ptr<const void> share_binding(const detail::dynamic_frame& frame) {
+    return *frame.shared;
+  }
+};
+
+#if defined(__cpp_deduction_guides) && __cpp_deduction_guides >= 201611L
+template <typename T, typename V>
+saver_dynamic(dynamic_var<T>&, V&&) -> saver_dynamic<T>;
+#endif
+
+} // namespace state_saver
+
+// SAVER_DYNAMIC overrides the dynamic variable for the current thread until scope exit.
+#define MAKE_SAVER_DYNAMIC(name, x, v) ::state_saver::saver_dynamic<typename std::remove_reference<decltype(x)>::type::value_type> name{x, v}
+#define SAVER_DYNAMIC(x, v) NEARGYE_MAYBE_UNUSED const MAKE_SAVER_DYNAMIC(NEARGYE_STR_CONCAT(SAVER_DYNAMIC_, NEARGYE_COUNTER), x, v)
+#define WITH_SAVER_DYNAMIC(x, v) NEARGYE_STATE_SAVER_WITH(SAVER_DYNAMIC(x, v))
+
+#endif // NEARGYE_STATE_SAVER_DYNAMIC_HPP
@@ -0,0 +1,275 @@
+//   _____ _        _          _____                         _____
+//  / ____| |      | |        / ____|                       / ____|_     _
+// | (___ | |_ __ _| |_ ___  | (___   __ ___   _____ _ __  | |   _| |_ _| |_
+//  \___ \| __/ _` | __/ _ \  \___ \ / _` \ \ / / _ \ '__| | |  |_   _|_   _|
+//  ____) | || (_| | ||  __/  ____) | (_| |\ V /  __/ |    | |____|_|   |_|
+// |_____/ \__\__,_|\__\___| |_____/ \__,_| \_/ \___|_|     \_____|
+// https://github.com/Neargye/state_saver
+// version 0.9.0
+//
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NEARGYE_STATE_SAVER_FIBER_HPP
+#define NEARGYE_STATE_SAVER_FIBER_HPP
+
+#include "state_saver.hpp"
+#include "state_saver_dynamic.hpp"
+
+#include <type_traits>
+#include <utility>
+
+namespace state_saver {
+
+namespace detail {
+
+// Entry of the list of savers active in a fiber.
+struct fiber_entry {
+  void* saver;
+  void (*swap)(void* saver);
+  fiber_entry* prev;
+  fiber_entry* next;
+};
+
+} // namespace state_saver::detail
+
+// fiber_state keeps overrides of fiber savers active in a fiber, and dynamic_var overrides of the fiber.
+// Scheduler must call fiber_switch(to) on each context switch, cost is O(number of overridden variables).
+class fiber_state {
+  detail::fiber_entry* first_ = nullptr;
+  detail::fiber_entry* last_ = nullptr;
+  detail::dynamic_frame* dynamic_top_ = nullptr;
+
+  static fiber_state*& current_ptr() noexcept {
+    static thread_local fiber_state* current = nullptr;
+    return current;
+  }
+
+  // Swaps saved values back in, innermost saver first.
+  void switch_out() {
+    for (detail::fiber_entry* entry = last_; entry != nullptr; entry = entry->prev) {
+      entry->swap(entry->saver);
+    }
+    dynamic_top_ = detail::dynamic_top();
+    detail::dynamic_unbind_stack(dynamic_top_);
+  }
+
+  // Swaps overrides in, outermost saver first.
+  void switch_in() {
+    detail::dynamic_top() = dynamic_top_;
+    detail::dynamic_bind_stack(dynamic_top_);
+    for (detail::fiber_entry* entry = first_; entry != nullptr; entry = entry->next) {
+      entry->swap(entry->saver);
+    }
+  }
+
+  friend void fiber_switch(fiber_state& to);
+
+ public:
+  fiber_state() = default;
+  fiber_state(const fiber_state&) = delete;
+  fiber_state& operator=(const fiber_state&) = delete;
+
+  // State of the fiber running in the current thread, thread own context if no fiber was switched to.
+  static fiber_state& current() noexcept {
+    fiber_state*& current = current_ptr();
+    if (current == nullptr) {
+      static thread_local fiber_state thread_state;
+      current = &thread_state;
+    }
+    return *current;
+  }
+
+  void push(detail::fiber_entry& entry) noexcept {
+    entry.prev = last_;
+    entry.next = nullptr;
+    if (last_ != nullptr) {
+      last_->next = &entry;
+    } else {
+      first_ = &entry;
+    }
+    last_ = &entry;
+  }
+
+  void pop(detail::fiber_entry& entry) noexcept {
+    if (entry.prev != nullptr) {
+      entry.prev->next = entry.next;
+    } else {
+      first_ = entry.next;
+    }
+    if (entry.next != nullptr) {
+      entry.next->prev = entry.prev;
+    } else {
+      last_ = entry.prev;
+    }
+  }
+
+  // Whether the fiber has no active overrides, dynamic_var overrides of the running fiber are read from the thread.
+  bool empty() const noexcept {
+    const detail::dynamic_frame* top = this == &current() ? detail::dynamic_top() : dynamic_top_;
+    return first_ == nullptr && top == nullptr;
+  }
+};
+
+// Switch hook, must be called by the scheduler on the thread before switching context to the fiber.
+inline void fiber_switch(fiber_state& to) {
+  fiber_state& from = fiber_state::current();
+  if (&from == &to) {
+    return;
+  }
+  from.switch_out();
+  to.switch_in();
+  fiber_state::current_ptr() = &to;
+}
+
+namespace detail {
+
+template <typename U, typename P>
+class fiber_saver {
+  using T = typename std::remove_reference<U>::type;
+  using assignable_t = typename assignable<T>::type;
+
+  static_assert(!std::is_const<T>::value,
+                "fiber_saver requires not const type.");
+  static_assert(!std::is_rvalue_reference<U>::value && (std::is_lvalue_reference<U>::value || std::is_same<T, U>::value),
+                "fiber_saver requires lvalue type.");
+  static_assert(!std::is_array<T>::value,
+                "fiber_saver requires not array type.");
+  static_assert(std::is_constructible<T, T&>::value,
+                "fiber_saver requires copy constructible.");
+  static_assert(std::is_assignable<T&, assignable_t>::value,
+                "fiber_saver requires operator=.");
+  static_assert(std::is_nothrow_move_constructible<T>::value && std::is_nothrow_move_assignable<T>::value,
+                "fiber_saver requires noexcept swap.");
+  static_assert(is_policy<P>::value,
+                "fiber_saver requires policy with explicit P(bool) noexcept, dismiss() noexcept and should_execute() const noexcept.");
+#if defined(STATE_SAVER_NO_THROW_RESTORE)
+  static_assert(std::is_nothrow_assignable<T&, assignable_t>::value,
+                "fiber_saver requires noexcept operator=.");
+#endif
+#if defined(STATE_SAVER_NO_THROW_CONSTRUCTIBLE)
+  static_assert(std::is_nothrow_constructible<T, T&>::value,
+                "fiber_saver requires nothrow constructible.");
+#endif
+
+  P policy_;
+  T& previous_ref_;
+  T previous_value_;
+  fiber_state& fiber_;
+  fiber_entry entry_;
+
+  static void swap_values(void* saver) {
+    fiber_saver& self = *static_cast<fiber_saver*>(saver);
+    using std::swap;
+    swap(self.previous_ref_, self.previous_value_);
+  }
+
+ public:
+  fiber_saver() = delete;
+  fiber_saver(const fiber_saver&) = delete;
+  fiber_saver(fiber_saver&&) = delete;
+  fiber_saver& operator=(const fiber_saver&) = delete;
+  fiber_saver& operator=(fiber_saver&&) = delete;
+
+  fiber_saver(T&&) = delete;
+  fiber_saver(const T&) = delete;
+
+  explicit fiber_saver(T& object) noexcept(std::is_nothrow_constructible<T, T&>::value)
+      : policy_{true},
+        previous_ref_{object},
+        previous_value_{object},
+        fiber_{fiber_state::current()},
+        entry_{this, &swap_values, nullptr, nullptr} {
+    fiber_.push(entry_);
+  }
+
+  void dismiss() noexcept {
+    policy_.dismiss();
+  }
+
+  void restore() noexcept(is_noexcept_restore<std::is_nothrow_assignable<T&, T&>::value>::value) {
+#if defined(STATE_SAVER_NO_THROW_RESTORE)
+    static_assert(std::is_nothrow_assignable<T&, T&>::value, "fiber_saver::restore requires noexcept copy operator=.");
+#endif
+    invoke_restore([this]() { previous_ref_ = previous_value_; });
+  }
+
+  ~fiber_saver() noexcept(is_noexcept_restore<std::is_nothrow_assignable<T&, assignable_t>::value>::value) {
+    fiber_.pop(entry_);
+    if (policy_.should_execute()) {
+      invoke_restore([this]() { previous_ref_ = static_cast<assignable_t>(previous_value_); });
+    }
+  }
+};
+
+} // namespace state_saver::detail
+
+// saver_exit_fiber saves the original variable value and restores on scope exit, the override is visible only while the fiber runs.
+template <typename U>
+class saver_exit_fiber : public detail::fiber_saver<U, detail::on_exit_policy> {
+ public:
+  using detail::fiber_saver<U, detail::on_exit_policy>::fiber_saver;
+};
+
+// saver_fail_fiber saves the original variable value and restores on scope exit when an exception has been thrown, the override is visible only while the fiber runs.
+template <typename U>
+class saver_fail_fiber : public detail::fiber_saver<U, detail::on_fail_policy> {
+ public:
+  using detail::fiber_saver<U, detail::on_fail_policy>::fiber_saver;
+};
+
+// saver_success_fiber saves the original variable value and restores on scope exit when no exceptions have been thrown, the override is visible only while the fiber runs.
+template <typename U>
+class saver_success_fiber : public detail::fiber_saver<U, detail::on_success_policy> {
+ public:
+  using detail::fiber_saver<U, detail::on_success_policy>::fiber_saver;
+};
+
+#if defined(__cpp_deduction_guides) && __cpp_deduction_guides >= 201611L
+template <typename U>
+saver_exit_fiber(U&) -> saver_exit_fiber<U>;
+
+template <typename U>
+saver_fail_fiber(U&) -> saver_fail_fiber<U>;
+
+template <typename U>
+saver_success_fiber(U&) -> saver_success_fiber<U>;
+#endif
+
+} // namespace state_saver
+
+// SAVER_EXIT_FIBER saves the original variable value and restores on scope exit, the override is visible only while the fiber runs.
+#define MAKE_SAVER_EXIT_FIBER(name, x) ::state_saver::saver_exit_fiber<decltype(x)> name{x}
+#define SAVER_EXIT_FIBER(x) NEARGYE_MAYBE_UNUSED const MAKE_SAVER_EXIT_FIBER(NEARGYE_STR_CONCAT(SAVER_EXIT_FIBER_, NEARGYE_COUNTER), x)
+#define WITH_SAVER_EXIT_FIBER(x) NEARGYE_STATE_SAVER_WITH(SAVER_EXIT_FIBER(x))
+
+// SAVER_FAIL_FIBER saves the original variable value and restores on scope exit when an exception has been thrown, the override is visible only while the fiber runs.
+#define MAKE_SAVER_FAIL_FIBER(name, x) ::state_saver::saver_fail_fiber<decltype(x)> name{x}
+#define SAVER_FAIL_FIBER(x) NEARGYE_MAYBE_UNUSED const MAKE_SAVER_FAIL_FIBER(NEARGYE_STR_CONCAT(SAVER_FAIL_FIBER_, NEARGYE_COUNTER), x)
+#define WITH_SAVER_FAIL_FIBER(x) NEARGYE_STATE_SAVER_WITH(SAVER_FAIL_FIBER(x))
+
+// SAVER_SUCCESS_FIBER saves the original variable value and restores on scope exit when no exceptions have been thrown, the override is visible only while the fiber runs.
+#define MAKE_SAVER_SUCCESS_FIBER(name, x) ::state_saver::saver_success_fiber<decltype(x)> name{x}
+#define SAVER_SUCCESS_FIBER(x) NEARGYE_MAYBE_UNUSED const MAKE_SAVER_SUCCESS_FIBER(NEARGYE_STR_CONCAT(SAVER_SUCCESS_FIBER_, NEARGYE_COUNTER), x)
+#define WITH_SAVER_SUCCESS_FIBER(x) NEARGYE_STATE_SAVER_WITH(SAVER_SUCCESS_FIBER(x))
+
+#endif // NEARGYE_STATE_SAVER_FIBER_HPP
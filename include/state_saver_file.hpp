@@ -0,0 +1,322 @@
+//   _____ _        _          _____                         _____
+//  / ____| |      | |        / ____|                       / ____|_     _
+// | (___ | |_ __ _| |_ ___  | (___   __ ___   _____ _ __  | |   _| |_ _| |_
+//  \___ \| __/ _` | __/ _ \  \___ \ / _` \ \ / / _ \ '__| | |  |_   _|_   _|
+//  ____) | || (_| | ||  __/  ____) | (_| |\ V /  __/ |    | |____|_|   |_|
+// |_____/ \__\__,_|\__\___| |_____/ \__,_| \_/ \___|_|     \_____|
+// https://github.com/Neargye/state_saver
+// version 0.9.0
+//
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NEARGYE_STATE_SAVER_FILE_HPP
+#define NEARGYE_STATE_SAVER_FILE_HPP
+
+#include "state_saver.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <cerrno>
+#include <cstdlib>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__linux__)
+#  include <sys/ioctl.h>
+#  include <linux/fs.h>
+#endif
+
+namespace state_saver {
+
+namespace detail {
+
+[[noreturn]] inline void throw_file_error(const char* what) {
+  throw std::system_error{errno, std::system_category(), what};
+}
+
+inline off_t file_size(int fd) {
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    throw_file_error("fstat");
+  }
+  return st.st_size;
+}
+
+inline std::size_t read_at(int fd, unsigned char* data, std::size_t count, off_t offset) {
+  std::size_t done = 0;
+  while (done < count) {
+    const ssize_t n = ::pread(fd, data + done, count - done, offset + static_cast<off_t>(done));
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw_file_error("pread");
+    }
+    if (n == 0) {
+      break; // End of file.
+    }
+    done += static_cast<std::size_t>(n);
+  }
+  return done;
+}
+
+inline void write_at(int fd, const unsigned char* data, std::size_t count, off_t offset) {
+  std::size_t done = 0;
+  while (done < count) {
+    const ssize_t n = ::pwrite(fd, data + done, count - done, offset + static_cast<off_t>(done));
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw_file_error("pwrite");
+    }
+    done += static_cast<std::size_t>(n);
+  }
+}
+
+inline void truncate_to(int fd, off_t size) {
+  if (file_size(fd) != size && ::ftruncate(fd, size) != 0) {
+    throw_file_error("ftruncate");
+  }
+}
+
+// Copies size bytes of src into dst, which is truncated to size.
+// Tries O(1) reflink clone first, then copy_file_range, then pread/pwrite.
+inline void copy_file(int src, int dst, off_t size) {
+#if defined(FICLONE)
+  if (::ioctl(dst, FICLONE, src) == 0) {
+    truncate_to(dst, size);
+    return;
+  }
+#endif
+  off_t offset = 0;
+#if defined(__linux__) && defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 27))
+  off_t in = 0;
+  off_t out = 0;
+  while (offset < size) {
+    const ssize_t n = ::copy_file_range(src, &in, dst, &out, static_cast<std::size_t>(size - offset), 0);
+    if (n <= 0) {
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      break; // Not supported for these files, finish with pread/pwrite.
+    }
+    offset += n;
+  }
+#endif
+  unsigned char buffer[16 * 1024];
+  while (offset < size) {
+    const std::size_t count = read_at(src, buffer, sizeof(buffer), offset);
+    if (count == 0) {
+      break;
+    }
+    write_at(dst, buffer, count, offset);
+    offset += static_cast<off_t>(count);
+  }
+  truncate_to(dst, size);
+}
+
+// Unnamed temporary file in dir, on the same file system clone is possible.
+inline int open_backup_file(const char* dir) {
+#if defined(O_TMPFILE)
+  const int fd = ::open(dir, O_TMPFILE | O_RDWR | O_CLOEXEC, S_IRUSR | S_IWUSR);
+  if (fd >= 0) {
+    return fd;
+  }
+#endif
+  std::string path{dir};
+  path += "/state_saver.XXXXXX";
+  const int fd_tmp = ::mkstemp(&path[0]);
+  if (fd_tmp < 0) {
+    throw_file_error("mkstemp");
+  }
+  ::unlink(path.c_str());
+  return fd_tmp;
+}
+
+class file_descriptor {
+  int fd_;
+
+ public:
+  file_descriptor(const file_descriptor&) = delete;
+  file_descriptor& operator=(const file_descriptor&) = delete;
+
+  explicit file_descriptor(int fd) noexcept : fd_{fd} {}
+
+  int get() const noexcept {
+    return fd_;
+  }
+
+  ~file_descriptor() noexcept {
+    ::close(fd_);
+  }
+};
+
+// Saves byte ranges of the file before they are modified, all ranges share one buffer.
+template <typename P>
+class file_region_saver {
+  static_assert(is_policy<P>::value,
+                "file_region_saver requires policy with explicit P(bool) noexcept, dismiss() noexcept and should_execute() const noexcept.");
+
+  struct region {
+    off_t offset;
+    std::size_t count;
+  };
+
+  P policy_;
+  int fd_;
+  off_t size_;
+  std::vector<region> regions_;
+  std::vector<unsigned char> buffer_;
+
+ public:
+  file_region_saver() = delete;
+  file_region_saver(const file_region_saver&) = delete;
+  file_region_saver(file_region_saver&&) = delete;
+  file_region_saver& operator=(const file_region_saver&) = delete;
+  file_region_saver& operator=(file_region_saver&&) = delete;
+
+  // Saves size of the file, ranges are added with save().
+  explicit file_region_saver(int fd) : policy_{true}, fd_{fd}, size_{file_size(fd)} {}
+
+  file_region_saver(int fd, off_t offset, std::size_t count) : file_region_saver{fd} {
+    save(offset, count);
+  }
+
+  // Saves [offset, offset + count) before it is modified, bytes past the end of file are restored by truncation.
+  void save(off_t offset, std::size_t count) {
+    const std::size_t pos = buffer_.size();
+    buffer_.resize(pos + count);
+    const std::size_t n = read_at(fd_, buffer_.data() + pos, count, offset);
+    buffer_.resize(pos + n);
+    if (n > 0) {
+      regions_.push_back({offset, n});
+    }
+  }
+
+  void dismiss() noexcept {
+    policy_.dismiss();
+  }
+
+  // Writes ranges back in reverse order, so overlapping ranges get the oldest bytes.
+  void restore() {
+    std::size_t pos = buffer_.size();
+    for (auto it = regions_.rbegin(); it != regions_.rend(); ++it) {
+      pos -= it->count;
+      write_at(fd_, buffer_.data() + pos, it->count, it->offset);
+    }
+    truncate_to(fd_, size_);
+  }
+
+  ~file_region_saver() noexcept(is_noexcept_restore<false>::value) {
+    if (policy_.should_execute()) {
+      invoke_restore([this]() { restore(); });
+    }
+  }
+};
+
+// Saves whole file into unnamed temporary file, reflink clone is used where the file system supports it.
+template <typename P>
+class file_clone_saver {
+  static_assert(is_policy<P>::value,
+                "file_clone_saver requires policy with explicit P(bool) noexcept, dismiss() noexcept and should_execute() const noexcept.");
+
+  P policy_;
+  int fd_;
+  off_t size_;
+  file_descriptor backup_;
+
+ public:
+  file_clone_saver() = delete;
+  file_clone_saver(const file_clone_saver&) = delete;
+  file_clone_saver(file_clone_saver&&) = delete;
+  file_clone_saver& operator=(const file_clone_saver&) = delete;
+  file_clone_saver& operator=(file_clone_saver&&) = delete;
+
+  // Backup file is created in dir, it should be on the same file system as the file for O(1) clone.
+  file_clone_saver(int fd, const char* dir) : policy_{true}, fd_{fd}, size_{file_size(fd)}, backup_{open_backup_file(dir)} {
+    copy_file(fd_, backup_.get(), size_);
+  }
+
+  void dismiss() noexcept {
+    policy_.dismiss();
+  }
+
+  void restore() {
+    copy_file(backup_.get(), fd_, size_);
+  }
+
+  ~file_clone_saver() noexcept(is_noexcept_restore<false>::value) {
+    if (policy_.should_execute()) {
+      invoke_restore([this]() { restore(); });
+    }
+  }
+};
+
+} // namespace state_saver::detail
+
+// saver_exit_file_region saves byte ranges of the file and restores on scope exit.
+class saver_exit_file_region : public detail::file_region_saver<detail::on_exit_policy> {
+ public:
+  using detail::file_region_saver<detail::on_exit_policy>::file_region_saver;
+};
+
+// saver_fail_file_region saves byte ranges of the file and restores on scope exit when an exception has been thrown.
+class saver_fail_file_region : public detail::file_region_saver<detail::on_fail_policy> {
+ public:
+  using detail::file_region_saver<detail::on_fail_policy>::file_region_saver;
+};
+
+// saver_success_file_region saves byte ranges of the file and restores on scope exit when no exceptions have been thrown.
+class saver_success_file_region : public detail::file_region_saver<detail::on_success_policy> {
+ public:
+  using detail::file_region_saver<detail::on_success_policy>::file_region_saver;
+};
+
+// saver_exit_file_clone saves whole file and restores on scope exit.
+class saver_exit_file_clone : public detail::file_clone_saver<detail::on_exit_policy> {
+ public:
+  using detail::file_clone_saver<detail::on_exit_policy>::file_clone_saver;
+};
+
+// saver_fail_file_clone saves whole file and restores on scope exit when an exception has been thrown.
+class saver_fail_file_clone : public detail::file_clone_saver<detail::on_fail_policy> {
+ public:
+  using detail::file_clone_saver<detail::on_fail_policy>::file_clone_saver;
+};
+
+// saver_success_file_clone saves whole file and restores on scope exit when no exceptions have been thrown.
+class saver_success_file_clone : public detail::file_clone_saver<detail::on_success_policy> {
+ public:
+  using detail::file_clone_saver<detail::on_success_policy>::file_clone_saver;
+};
+
+} // namespace state_saver
+
+#endif // defined(__unix__) || defined(__APPLE__)
+
+#endif // NEARGYE_STATE_SAVER_FILE_HPP
@@ -0,0 +1,170 @@
+//   _____ _        _          _____                         _____
+//  / ____| |      | |        / ____|                       / ____|_     _
+// | (___ | |_ __ _| |_ ___  | (___   __ ___   _____ _ __  | |   _| |_ _| |_
+//  \___ \| __/ _` | __/ _ \  \___ \ / _` \ \ / / _ \ '__| | |  |_   _|_   _|
+//  ____) | || (_| | ||  __/  ____) | (_| |\ V /  __/ |    | |____|_|   |_|
+// |_____/ \__\__,_|\__\___| |_____/ \__,_| \_/ \___|_|     \_____|
+// https://github.com/Neargye/state_saver
+// version 0.9.0
+//
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NEARGYE_STATE_SAVER_FPENV_HPP
+#define NEARGYE_STATE_SAVER_FPENV_HPP
+
+#include "state_saver.hpp"
+
+#include <cfenv>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#  include <xmmintrin.h>
+#  define NEARGYE_STATE_SAVER_MXCSR 1
+#endif
+
+namespace state_saver {
+
+namespace detail {
+
+// Saves the full floating-point environment of the current thread, and the MXCSR register (FTZ/DAZ bits are not restored by fesetenv everywhere).
+template <typename P>
+class fpenv_saver {
+  static_assert(is_policy<P>::value,
+                "fpenv_saver requires policy with explicit P(bool) noexcept, dismiss() noexcept and should_execute() const noexcept.");
+
+  P policy_;
+  std::fenv_t previous_env_;
+#if defined(NEARGYE_STATE_SAVER_MXCSR)
+  unsigned int previous_mxcsr_;
+#endif
+
+ public:
+  fpenv_saver(const fpenv_saver&) = delete;
+  fpenv_saver(fpenv_saver&&) = delete;
+  fpenv_saver& operator=(const fpenv_saver&) = delete;
+  fpenv_saver& operator=(fpenv_saver&&) = delete;
+
+  fpenv_saver() noexcept : policy_{true} {
+    std::fegetenv(&previous_env_);
+#if defined(NEARGYE_STATE_SAVER_MXCSR)
+    previous_mxcsr_ = _mm_getcsr();
+#endif
+  }
+
+  void dismiss() noexcept {
+    policy_.dismiss();
+  }
+
+  void restore() noexcept {
+    std::fesetenv(&previous_env_);
+#if defined(NEARGYE_STATE_SAVER_MXCSR)
+    _mm_setcsr(previous_mxcsr_);
+#endif
+  }
+
+  ~fpenv_saver() noexcept {
+    if (policy_.should_execute()) {
+      restore();
+    }
+  }
+};
+
+#if defined(NEARGYE_STATE_SAVER_MXCSR)
+// Saves only the MXCSR register: SSE rounding mode, FTZ/DAZ, exception masks and flags.
+// Two instructions, cheap enough to wrap every SIMD kernel call, restore is skipped if the value did not change.
+template <typename P>
+class mxcsr_saver {
+  static_assert(is_policy<P>::value,
+                "mxcsr_saver requires policy with explicit P(bool) noexcept, dismiss() noexcept and should_execute() const noexcept.");
+
+  P policy_;
+  unsigned int previous_mxcsr_;
+
+ public:
+  mxcsr_saver(const mxcsr_saver&) = delete;
+  mxcsr_saver(mxcsr_saver&&) = delete;
+  mxcsr_saver& operator=(const mxcsr_saver&) = delete;
+  mxcsr_saver& operator=(mxcsr_saver&&) = delete;
+
+  mxcsr_saver() noexcept : policy_{true}, previous_mxcsr_{_mm_getcsr()} {}
+
+  void dismiss() noexcept {
+    policy_.dismiss();
+  }
+
+  void restore() noexcept {
+    if (_mm_getcsr() != previous_mxcsr_) {
+      _mm_setcsr(previous_mxcsr_);
+    }
+  }
+
+  ~mxcsr_saver() noexcept {
+    if (policy_.should_execute()) {
+      restore();
+    }
+  }
+};
+#endif
+
+} // namespace state_saver::detail
+
+// saver_exit_fpenv saves the floating-point environment and restores on scope exit.
+class saver_exit_fpenv : public detail::fpenv_saver<detail::on_exit_policy> {
+ public:
+  using detail::fpenv_saver<detail::on_exit_policy>::fpenv_saver;
+};
+
+// saver_fail_fpenv saves the floating-point environment and restores on scope exit when an exception has been thrown.
+class saver_fail_fpenv : public detail::fpenv_saver<detail::on_fail_policy> {
+ public:
+  using detail::fpenv_saver<detail::on_fail_policy>::fpenv_saver;
+};
+
+// saver_success_fpenv saves the floating-point environment and restores on scope exit when no exceptions have been thrown.
+class saver_success_fpenv : public detail::fpenv_saver<detail::on_success_policy> {
+ public:
+  using detail::fpenv_saver<detail::on_success_policy>::fpenv_saver;
+};
+
+#if defined(NEARGYE_STATE_SAVER_MXCSR)
+// saver_exit_mxcsr saves the MXCSR register and restores on scope exit.
+class saver_exit_mxcsr : public detail::mxcsr_saver<detail::on_exit_policy> {
+ public:
+  using detail::mxcsr_saver<detail::on_exit_policy>::mxcsr_saver;
+};
+
+// saver_fail_mxcsr saves the MXCSR register and restores on scope exit when an exception has been thrown.
+class saver_fail_mxcsr : public detail::mxcsr_saver<detail::on_fail_policy> {
+ public:
+  using detail::mxcsr_saver<detail::on_fail_policy>::mxcsr_saver;
+};
+
+// saver_success_mxcsr saves the MXCSR register and restores on scope exit when no exceptions have been thrown.
+class saver_success_mxcsr : public detail::mxcsr_saver<detail::on_success_policy> {
+ public:
+  using detail::mxcsr_saver<detail::on_success_policy>::mxcsr_saver;
+};
+#endif
+
+} // namespace state_saver
+
+#endif // NEARGYE_STATE_SAVER_FPENV_HPP
@@ -0,0 +1,276 @@
+//   _____ _        _          _____                         _____
+//  / ____| |      | |        / ____|                       / ____|_     _
+// | (___ | |_ __ _| |_ ___  | (___   __ ___   _____ _ __  | |   _| |_ _| |_
+//  \___ \| __/ _` | __/ _ \  \___ \ / _` \ \ / / _ \ '__| | |  |_   _|_   _|
+//  ____) | || (_| | ||  __/  ____) | (_| |\ V /  __/ |    | |____|_|   |_|
+// |_____/ \__\__,_|\__\___| |_____/ \__,_| \_/ \___|_|     \_____|
+// https://github.com/Neargye/state_saver
+// version 0.9.0
+//
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NEARGYE_STATE_SAVER_HISTORY_HPP
+#define NEARGYE_STATE_SAVER_HISTORY_HPP
+
+#include "state_saver.hpp"
+
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace state_saver {
+
+namespace detail {
+
+// Keeps whole versions, used for types that are not trivially copyable.
+template <typename T>
+class value_history {
+  using assignable_t = typename assignable<T>::type;
+
+  static_assert(std::is_constructible<T, T&>::value,
+                "history requires copy constructible.");
+  static_assert(std::is_assignable<T&, T&>::value,
+                "history requires copy operator=.");
+
+  T& object_;
+  std::size_t max_entries_;
+  std::deque<T> versions_;
+  std::size_t current_;
+
+ public:
+  value_history(T& object, std::size_t max_entries, std::size_t max_bytes)
+      : object_{object},
+        max_entries_{max_bytes / sizeof(T) < max_entries ? (max_bytes / sizeof(T) == 0 ? 1 : max_bytes / sizeof(T)) : max_entries},
+        versions_{},
+        current_{0} {
+    versions_.emplace_back(object_);
+  }
+
+  bool checkpoint() {
+    versions_.erase(versions_.begin() + static_cast<std::ptrdiff_t>(current_) + 1, versions_.end());
+    versions_.emplace_back(object_);
+    if (versions_.size() > max_entries_ + 1) {
+      versions_.pop_front();
+    } else {
+      ++current_;
+    }
+    return true;
+  }
+
+  bool undo() {
+    if (current_ == 0) {
+      return false;
+    }
+    object_ = versions_[--current_];
+    return true;
+  }
+
+  bool redo() {
+    if (current_ + 1 == versions_.size()) {
+      return false;
+    }
+    object_ = versions_[++current_];
+    return true;
+  }
+
+  std::size_t undo_count() const noexcept {
+    return current_;
+  }
+
+  std::size_t redo_count() const noexcept {
+    return versions_.size() - current_ - 1;
+  }
+
+  std::size_t memory_usage() const noexcept {
+    return versions_.size() * sizeof(T);
+  }
+};
+
+// Keeps current version and byte deltas between successive versions, used for trivially copyable types.
+template <typename T>
+class byte_history {
+  // Equal bytes between changed ranges shorter than this are stored in the delta, so ranges are not too fragmented.
+  static constexpr std::size_t merge_gap = 16;
+  static constexpr std::size_t block_size = 64;
+
+  struct range {
+    std::size_t offset;
+    std::size_t size;
+  };
+
+  // Changed ranges with old and new bytes, both stored one after another in bytes.
+  struct delta {
+    std::vector<range> ranges;
+    std::vector<unsigned char> bytes;
+
+    std::size_t memory_usage() const noexcept {
+      return ranges.size() * sizeof(range) + bytes.size();
+    }
+  };
+
+  T& object_;
+  std::size_t max_entries_;
+  std::size_t max_bytes_;
+  std::vector<unsigned char> base_;
+  std::deque<delta> deltas_;
+  std::size_t current_;
+  std::size_t memory_;
+
+  unsigned char* data() noexcept {
+    return reinterpret_cast<unsigned char*>(std::addressof(object_));
+  }
+
+  std::vector<range> diff() {
+    std::vector<range> ranges;
+    const unsigned char* lhs = base_.data();
+    const unsigned char* rhs = data();
+    std::size_t i = 0;
+    while (i < sizeof(T)) {
+      const std::size_t n = sizeof(T) - i < block_size ? sizeof(T) - i : block_size;
+      if (std::memcmp(lhs + i, rhs + i, n) == 0) {
+        i += n;
+        continue;
+      }
+      for (const std::size_t end = i + n; i < end; ++i) {
+        if (lhs[i] == rhs[i]) {
+          continue;
+        }
+        if (!ranges.empty() && i - (ranges.back().offset + ranges.back().size) <= merge_gap) {
+          ranges.back().size = i + 1 - ranges.back().offset;
+        } else {
+          ranges.push_back({i, 1});
+        }
+      }
+    }
+    return ranges;
+  }
+
+  // Copies old (or new) bytes of the delta into the object and the base.
+  void apply(const delta& d, bool old_bytes) noexcept {
+    std::size_t pos = 0;
+    for (const auto& r : d.ranges) {
+      const unsigned char* bytes = d.bytes.data() + pos + (old_bytes ? 0 : r.size);
+      std::memcpy(data() + r.offset, bytes, r.size);
+      std::memcpy(base_.data() + r.offset, bytes, r.size);
+      pos += 2 * r.size;
+    }
+  }
+
+ public:
+  byte_history(T& object, std::size_t max_entries, std::size_t max_bytes)
+      : object_{object},
+        max_entries_{max_entries},
+        max_bytes_{max_bytes},
+        base_{reinterpret_cast<const unsigned char*>(std::addressof(object)), reinterpret_cast<const unsigned char*>(std::addressof(object)) + sizeof(T)},
+        deltas_{},
+        current_{0},
+        memory_{0} {}
+
+  // Stores only changed ranges, returns false if nothing changed since the last checkpoint.
+  bool checkpoint() {
+    delta d;
+    d.ranges = diff();
+    if (d.ranges.empty()) {
+      return false;
+    }
+    for (const auto& r : d.ranges) {
+      d.bytes.insert(d.bytes.end(), base_.data() + r.offset, base_.data() + r.offset + r.size);
+      d.bytes.insert(d.bytes.end(), data() + r.offset, data() + r.offset + r.size);
+      std::memcpy(base_.data() + r.offset, data() + r.offset, r.size);
+    }
+    while (deltas_.size() > current_) {
+      memory_ -= deltas_.back().memory_usage();
+      deltas_.pop_back();
+    }
+    memory_ += d.memory_usage();
+    deltas_.push_back(std::move(d));
+    ++current_;
+    while (deltas_.size() > 1 && (deltas_.size() > max_entries_ || memory_ > max_bytes_)) {
+      memory_ -= deltas_.front().memory_usage();
+      deltas_.pop_front();
+      --current_;
+    }
+    return true;
+  }
+
+  bool undo() {
+    if (current_ == 0) {
+      return false;
+    }
+    std::memcpy(data(), base_.data(), sizeof(T)); // Discard changes after the last checkpoint.
+    apply(deltas_[--current_], true);
+    return true;
+  }
+
+  bool redo() {
+    if (current_ == deltas_.size()) {
+      return false;
+    }
+    std::memcpy(data(), base_.data(), sizeof(T));
+    apply(deltas_[current_++], false);
+    return true;
+  }
+
+  std::size_t undo_count() const noexcept {
+    return current_;
+  }
+
+  std::size_t redo_count() const noexcept {
+    return deltas_.size() - current_;
+  }
+
+  std::size_t memory_usage() const noexcept {
+    return base_.size() + memory_;
+  }
+};
+
+template <typename T>
+using history_base = typename std::conditional<std::is_trivially_copyable<T>::value, byte_history<T>, value_history<T>>::type;
+
+} // namespace state_saver::detail
+
+// history keeps bounded number of checkpointed versions of the object for undo and redo.
+// Trivially copyable objects are stored as byte deltas, so memory is proportional to the change.
+// checkpoint() stores the current value as new version, redo versions are dropped.
+// undo() and redo() discard changes after the last checkpoint and move to the previous or the next version.
+template <typename T>
+class history : public detail::history_base<T> {
+  static_assert(!std::is_const<T>::value && !std::is_reference<T>::value,
+                "history requires not const and not reference type.");
+
+ public:
+  history(const history&) = delete;
+  history(history&&) = delete;
+  history& operator=(const history&) = delete;
+  history& operator=(history&&) = delete;
+
+  // Current value of the object is the first version.
+  explicit history(T& object, std::size_t max_entries = 64, std::size_t max_bytes = 1 << 20)
+      : detail::history_base<T>{object, max_entries == 0 ? 1 : max_entries, max_bytes} {}
+};
+
+} // namespace state_saver
+
+#endif // NEARGYE_STATE_SAVER_HISTORY_HPP
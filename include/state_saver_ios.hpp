@@ -0,0 +1,162 @@
+//   _____ _        _          _____                         _____
+//  / ____| |      | |        / ____|                       / ____|_     _
+// | (___ | |_ __ _| |_ ___  | (___   __ ___   _____ _ __  | |   _| |_ _| |_
+//  \___ \| __/ _` | __/ _ \  \___ \ / _` \ \ / / _ \ '__| | |  |_   _|_   _|
+//  ____) | || (_| | ||  __/  ____) | (_| |\ V /  __/ |    | |____|_|   |_|
+// |_____/ \__\__,_|\__\___| |_____/ \__,_| \_/ \___|_|     \_____|
+// https://github.com/Neargye/state_saver
+// version 0.9.0
+//
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NEARGYE_STATE_SAVER_IOS_HPP
+#define NEARGYE_STATE_SAVER_IOS_HPP
+
+#include "state_saver.hpp"
+
+#include <ios>
+#include <locale>
+#include <type_traits>
+
+namespace state_saver {
+
+namespace detail {
+
+template <typename U, typename P>
+class ios_saver {
+  using T = typename std::remove_reference<U>::type;
+  using ios_t = std::basic_ios<typename T::char_type, typename T::traits_type>;
+
+  static_assert(!std::is_const<T>::value,
+                "ios_saver requires not const type.");
+  static_assert(!std::is_rvalue_reference<U>::value && (std::is_lvalue_reference<U>::value || std::is_same<T, U>::value),
+                "ios_saver requires lvalue type.");
+  static_assert(std::is_base_of<ios_t, T>::value,
+                "ios_saver requires stream type.");
+  static_assert(is_policy<P>::value,
+                "ios_saver requires policy with explicit P(bool) noexcept, dismiss() noexcept and should_execute() const noexcept.");
+
+  P policy_;
+  ios_t& previous_ref_;
+  std::ios_base::fmtflags flags_;
+  std::streamsize precision_;
+  std::streamsize width_;
+  typename T::char_type fill_;
+  std::ios_base::iostate exceptions_;
+  std::locale locale_;
+
+ public:
+  ios_saver() = delete;
+  ios_saver(const ios_saver&) = delete;
+  ios_saver(ios_saver&&) = delete;
+  ios_saver& operator=(const ios_saver&) = delete;
+  ios_saver& operator=(ios_saver&&) = delete;
+
+  // Saves flags, precision, width, fill, exceptions mask and locale of the stream.
+  explicit ios_saver(T& stream)
+      : policy_{true},
+        previous_ref_{stream},
+        flags_{stream.flags()},
+        precision_{stream.precision()},
+        width_{stream.width()},
+        fill_{stream.fill()},
+        exceptions_{stream.exceptions()},
+        locale_{stream.getloc()} {}
+
+  void dismiss() noexcept {
+    policy_.dismiss();
+  }
+
+  // Imbue is skipped if the locale did not change, exceptions mask is restored last since it may throw.
+  void restore() {
+    previous_ref_.flags(flags_);
+    previous_ref_.precision(precision_);
+    previous_ref_.width(width_);
+    previous_ref_.fill(fill_);
+    if (previous_ref_.getloc() != locale_) {
+      previous_ref_.imbue(locale_);
+    }
+    if (previous_ref_.exceptions() != exceptions_) {
+      previous_ref_.exceptions(exceptions_);
+    }
+  }
+
+  ~ios_saver() noexcept(is_noexcept_restore<false>::value) {
+    if (policy_.should_execute()) {
+      invoke_restore([this]() { restore(); });
+    }
+  }
+};
+
+} // namespace state_saver::detail
+
+// saver_exit_ios saves the formatting state of the stream and restores on scope exit.
+template <typename U>
+class saver_exit_ios : public detail::ios_saver<U, detail::on_exit_policy> {
+ public:
+  using detail::ios_saver<U, detail::on_exit_policy>::ios_saver;
+};
+
+// saver_fail_ios saves the formatting state of the stream and restores on scope exit when an exception has been thrown.
+template <typename U>
+class saver_fail_ios : public detail::ios_saver<U, detail::on_fail_policy> {
+ public:
+  using detail::ios_saver<U, detail::on_fail_policy>::ios_saver;
+};
+
+// saver_success_ios saves the formatting state of the stream and restores on scope exit when no exceptions have been thrown.
+template <typename U>
+class saver_success_ios : public detail::ios_saver<U, detail::on_success_policy> {
+ public:
+  using detail::ios_saver<U, detail::on_success_policy>::ios_saver;
+};
+
+#if defined(__cpp_deduction_guides) && __cpp_deduction_guides >= 201611L
+template <typename U>
+saver_exit_ios(U&) -> saver_exit_ios<U>;
+
+template <typename U>
+saver_fail_ios(U&) -> saver_fail_ios<U>;
+
+template <typename U>
+saver_success_ios(U&) -> saver_success_ios<U>;
+#endif
+
+} // namespace state_saver
+
+// SAVER_EXIT_IOS saves the formatting state of the stream and restores on scope exit.
+#define MAKE_SAVER_EXIT_IOS(name, x) ::state_saver::saver_exit_ios<decltype(x)> name{x}
+#define SAVER_EXIT_IOS(x) NEARGYE_MAYBE_UNUSED const MAKE_SAVER_EXIT_IOS(NEARGYE_STR_CONCAT(SAVER_EXIT_IOS_, NEARGYE_COUNTER), x)
+#define WITH_SAVER_EXIT_IOS(x) NEARGYE_STATE_SAVER_WITH(SAVER_EXIT_IOS(x))
+
+// SAVER_FAIL_IOS saves the formatting state of the stream and restores on scope exit when an exception has been thrown.
+#define MAKE_SAVER_FAIL_IOS(name, x) ::state_saver::saver_fail_ios<decltype(x)> name{x}
+#define SAVER_FAIL_IOS(x) NEARGYE_MAYBE_UNUSED const MAKE_SAVER_FAIL_IOS(NEARGYE_STR_CONCAT(SAVER_FAIL_IOS_, NEARGYE_COUNTER), x)
+#define WITH_SAVER_FAIL_IOS(x) NEARGYE_STATE_SAVER_WITH(SAVER_FAIL_IOS(x))
+
+// SAVER_SUCCESS_IOS saves the formatting state of the stream and restores on scope exit when no exceptions have been thrown.
+#define MAKE_SAVER_SUCCESS_IOS(name, x) ::state_saver::saver_success_ios<decltype(x)> name{x}
+#define SAVER_SUCCESS_IOS(x) NEARGYE_MAYBE_UNUSED const MAKE_SAVER_SUCCESS_IOS(NEARGYE_STR_CONCAT(SAVER_SUCCESS_IOS_, NEARGYE_COUNTER), x)
+#define WITH_SAVER_SUCCESS_IOS(x) NEARGYE_STATE_SAVER_WITH(SAVER_SUCCESS_IOS(x))
+
+#endif // NEARGYE_STATE_SAVER_IOS_HPP
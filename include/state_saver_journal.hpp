@@ -0,0 +1,347 @@
+//   _____ _        _          _____                         _____
+//  / ____| |      | |        / ____|                       / ____|_     _
+// | (___ | |_ __ _| |_ ___  | (___   __ ___   _____ _ __  | |   _| |_ _| |_
+//  \___ \| __/ _` | __/ _ \  \___ \ / _` \ \ / / _ \ '__| | |  |_   _|_   _|
+//  ____) | || (_| | ||  __/  ____) | (_| |\ V /  __/ |    | |____|_|   |_|
+// |_____/ \__\__,_|\__\___| |_____/ \__,_| \_/ \___|_|     \_____|
+// https://github.com/Neargye/state_saver
+// version 0.9.0
+//
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NEARGYE_STATE_SAVER_JOURNAL_HPP
+#define NEARGYE_STATE_SAVER_JOURNAL_HPP
+
+#include "state_saver.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace state_saver {
+
+namespace detail {
+
+template <typename P>
+class journal_saver;
+
+[[noreturn]] inline void throw_journal_error(const char* what) {
+  throw std::system_error{errno, std::system_category(), what};
+}
+
+// FNV-1a, detects torn records after crash.
+inline std::uint64_t journal_checksum(const unsigned char* data, std::size_t size, std::uint64_t hash = 14695981039346656037ULL) noexcept {
+  for (std::size_t i = 0; i < size; ++i) {
+    hash = (hash ^ data[i]) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+inline void sync_range(const void* data, std::size_t size) {
+  const auto page = static_cast<std::uintptr_t>(::sysconf(_SC_PAGESIZE));
+  const auto begin = reinterpret_cast<std::uintptr_t>(data) & ~(page - 1);
+  const auto end = reinterpret_cast<std::uintptr_t>(data) + size;
+  if (::msync(reinterpret_cast<void*>(begin), end - begin, MS_SYNC) != 0) {
+    throw_journal_error("msync");
+  }
+}
+
+} // namespace state_saver::detail
+
+// Undo log in memory-mapped file for data in the shared file mapping [base, base + size).
+// Records of unfinished transaction are replayed in reverse order when the journal is opened.
+class undo_journal {
+  template <typename P>
+  friend class detail::journal_saver;
+
+  struct header {
+    std::uint64_t magic;
+    std::uint64_t sequence;
+  };
+
+  struct record {
+    std::uint64_t sequence;
+    std::uint64_t offset;
+    std::uint64_t size;
+    std::uint64_t checksum;
+  };
+
+  static constexpr std::uint64_t journal_magic = 0x4C4E524A5653534EULL;
+
+  unsigned char* base_;
+  std::size_t size_;
+  unsigned char* journal_;
+  std::size_t capacity_;
+  std::size_t end_;
+  std::size_t depth_;
+  std::size_t recovered_;
+
+  static std::size_t aligned(std::size_t size) noexcept {
+    return (size + 7) & ~static_cast<std::size_t>(7);
+  }
+
+  std::uint64_t sequence() const noexcept {
+    header h;
+    std::memcpy(&h, journal_, sizeof(h));
+    return h.sequence;
+  }
+
+  void set_sequence(std::uint64_t sequence) {
+    const header h{journal_magic, sequence};
+    std::memcpy(journal_, &h, sizeof(h));
+    detail::sync_range(journal_, sizeof(h));
+  }
+
+  // Returns position of the next record, or 0 if record at pos is not valid.
+  std::size_t next_record(std::size_t pos, record& r) const noexcept {
+    if (pos + sizeof(r) > capacity_) {
+      return 0;
+    }
+    std::memcpy(&r, journal_ + pos, sizeof(r));
+    if (r.sequence != sequence() || r.offset > size_ || r.size > size_ - r.offset || r.size > capacity_ - pos - sizeof(r)) {
+      return 0;
+    }
+    const std::uint64_t checksum = r.checksum;
+    r.checksum = 0;
+    if (detail::journal_checksum(journal_ + pos + sizeof(r), r.size, detail::journal_checksum(reinterpret_cast<const unsigned char*>(&r), sizeof(r))) != checksum) {
+      return 0;
+    }
+    return pos + sizeof(r) + aligned(r.size);
+  }
+
+  // Copies old bytes of records in [begin, end) back to the data in reverse order.
+  void replay(std::size_t begin, std::size_t end) {
+    std::vector<std::size_t> records;
+    record r;
+    for (std::size_t pos = begin; pos != 0 && pos != end; pos = next_record(pos, r)) {
+      records.push_back(pos);
+    }
+    for (auto it = records.rbegin(); it != records.rend(); ++it) {
+      next_record(*it, r);
+      std::memcpy(base_ + r.offset, journal_ + *it + sizeof(r), r.size);
+    }
+  }
+
+  void append(const void* data, std::size_t size) {
+    const auto* p = static_cast<const unsigned char*>(data);
+    if (p < base_ || p + size > base_ + size_) {
+      throw std::out_of_range{"undo_journal: saved object is outside of the journaled mapping."};
+    }
+    if (end_ + sizeof(record) + aligned(size) > capacity_) {
+      throw std::length_error{"undo_journal: journal capacity exceeded."};
+    }
+    record r{sequence(), static_cast<std::uint64_t>(p - base_), static_cast<std::uint64_t>(size), 0};
+    std::memcpy(journal_ + end_, &r, sizeof(r));
+    std::memcpy(journal_ + end_ + sizeof(r), p, size);
+    r.checksum = detail::journal_checksum(p, size, detail::journal_checksum(reinterpret_cast<const unsigned char*>(&r), sizeof(r)));
+    std::memcpy(journal_ + end_, &r, sizeof(r));
+    end_ += sizeof(r) + aligned(size);
+  }
+
+  // Makes records in [begin, end_) durable, it must happen before the data is modified.
+  void flush(std::size_t begin) {
+    if (begin != end_) {
+      detail::sync_range(journal_ + begin, end_ - begin);
+    }
+  }
+
+  // Makes the data durable and invalidates all records with one header write.
+  void commit() {
+    detail::sync_range(base_, size_);
+    set_sequence(sequence() + 1);
+    end_ = sizeof(header);
+  }
+
+ public:
+  undo_journal(const undo_journal&) = delete;
+  undo_journal(undo_journal&&) = delete;
+  undo_journal& operator=(const undo_journal&) = delete;
+  undo_journal& operator=(undo_journal&&) = delete;
+
+  // Opens or creates journal file at path and recovers the data from unfinished transaction.
+  undo_journal(const char* path, void* base, std::size_t size, std::size_t capacity = 1 << 20)
+      : base_{static_cast<unsigned char*>(base)}, size_{size}, journal_{nullptr}, capacity_{capacity}, end_{sizeof(header)}, depth_{0}, recovered_{0} {
+    if (capacity_ < sizeof(header) + sizeof(record)) {
+      throw std::invalid_argument{"undo_journal: capacity is too small."};
+    }
+    const int fd = ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+      detail::throw_journal_error("open");
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || (static_cast<std::size_t>(st.st_size) < capacity_ && ::ftruncate(fd, static_cast<off_t>(capacity_)) != 0)) {
+      const int error = errno;
+      ::close(fd);
+      errno = error;
+      detail::throw_journal_error("ftruncate");
+    }
+    void* journal = ::mmap(nullptr, capacity_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (journal == MAP_FAILED) {
+      detail::throw_journal_error("mmap");
+    }
+    journal_ = static_cast<unsigned char*>(journal);
+
+    header h;
+    std::memcpy(&h, journal_, sizeof(h));
+    if (h.magic != journal_magic) {
+      set_sequence(1);
+      return;
+    }
+    record r;
+    std::size_t end = sizeof(header);
+    for (std::size_t pos = next_record(end, r); pos != 0; pos = next_record(end, r)) {
+      end = pos;
+      ++recovered_;
+    }
+    if (recovered_ != 0) {
+      replay(sizeof(header), end);
+      commit();
+    }
+  }
+
+  // Number of records replayed when the journal was opened.
+  std::size_t recovered() const noexcept {
+    return recovered_;
+  }
+
+  ~undo_journal() noexcept {
+    ::munmap(journal_, capacity_);
+  }
+};
+
+namespace detail {
+
+// Journals old bytes of objects, one journal flush per save() call and one data flush per outermost scope.
+template <typename P>
+class journal_saver {
+  static_assert(is_policy<P>::value,
+                "journal_saver requires policy with explicit P(bool) noexcept, dismiss() noexcept and should_execute() const noexcept.");
+
+  P policy_;
+  undo_journal& journal_;
+  std::size_t begin_;
+
+  void append_all() noexcept {}
+
+  template <typename T, typename... Ts>
+  void append_all(T& object, Ts&... objects) {
+    static_assert(std::is_trivially_copyable<T>::value, "journal_saver requires trivially copyable objects.");
+    journal_.append(std::addressof(object), sizeof(T));
+    append_all(objects...);
+  }
+
+ public:
+  journal_saver() = delete;
+  journal_saver(const journal_saver&) = delete;
+  journal_saver(journal_saver&&) = delete;
+  journal_saver& operator=(const journal_saver&) = delete;
+  journal_saver& operator=(journal_saver&&) = delete;
+
+  template <typename... Ts>
+  explicit journal_saver(undo_journal& journal, Ts&... objects) : policy_{true}, journal_{journal}, begin_{journal.end_} {
+    ++journal_.depth_;
+    try {
+      save(objects...);
+    } catch (...) {
+      journal_.end_ = begin_;
+      --journal_.depth_;
+      throw;
+    }
+  }
+
+  // Journals objects before they are modified, records are made durable with one msync.
+  template <typename... Ts>
+  void save(Ts&... objects) {
+    const std::size_t begin = journal_.end_;
+    append_all(objects...);
+    journal_.flush(begin);
+  }
+
+  // Saves raw bytes of the journaled mapping.
+  void save_bytes(void* data, std::size_t size) {
+    const std::size_t begin = journal_.end_;
+    journal_.append(data, size);
+    journal_.flush(begin);
+  }
+
+  void dismiss() noexcept {
+    policy_.dismiss();
+  }
+
+  void restore() {
+    journal_.replay(begin_, journal_.end_);
+  }
+
+  // Nested scope leaves records to the outermost one, so crash rolls back the whole transaction.
+  // Records of rolled back nested scope are kept too, its restored bytes are durable only after the outermost commit.
+  ~journal_saver() noexcept(is_noexcept_restore<false>::value) {
+    const bool rollback = policy_.should_execute();
+    --journal_.depth_;
+    invoke_restore([this, rollback]() {
+      if (rollback) {
+        restore();
+      }
+      if (journal_.depth_ == 0) {
+        journal_.commit();
+      }
+    });
+  }
+};
+
+} // namespace state_saver::detail
+
+// saver_exit_journal journals objects in undo_journal and rolls back on scope exit.
+class saver_exit_journal : public detail::journal_saver<detail::on_exit_policy> {
+ public:
+  using detail::journal_saver<detail::on_exit_policy>::journal_saver;
+};
+
+// saver_fail_journal journals objects in undo_journal and rolls back on scope exit when an exception has been thrown.
+class saver_fail_journal : public detail::journal_saver<detail::on_fail_policy> {
+ public:
+  using detail::journal_saver<detail::on_fail_policy>::journal_saver;
+};
+
+// saver_success_journal journals objects in undo_journal and rolls back on scope exit when no exceptions have been thrown.
+class saver_success_journal : public detail::journal_saver<detail::on_success_policy> {
+ public:
+  using detail::journal_saver<detail::on_success_policy>::journal_saver;
+};
+
+} // namespace state_saver
+
+#endif // defined(__unix__) || defined(__APPLE__)
+
+#endif // NEARGYE_STATE_SAVER_JOURNAL_HPP
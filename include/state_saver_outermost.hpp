@@ -0,0 +1,242 @@
+//   _____ _        _          _____                         _____
+//  / ____| |      | |        / ____|                       / ____|_     _
+// | (___ | |_ __ _| |_ ___  | (___   __ ___   _____ _ __  | |   _| |_ _| |_
+//  \___ \| __/ _` | __/ _ \  \___ \ / _` \ \ / / _ \ '__| | |  |_   _|_   _|
+//  ____) | || (_| | ||  __/  ____) | (_| |\ V /  __/ |    | |____|_|   |_|
+// |_____/ \__\__,_|\__\___| |_____/ \__,_| \_/ \___|_|     \_____|
+// https://github.com/Neargye/state_saver
+// version 0.9.0
+//
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NEARGYE_STATE_SAVER_OUTERMOST_HPP
+#define NEARGYE_STATE_SAVER_OUTERMOST_HPP
+
+#include "state_saver.hpp"
+
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace state_saver {
+
+namespace detail {
+
+// Active outermost saver of the object, nodes are linked through the savers on the stack.
+struct outermost_node {
+  const void* object;
+  const void* policy;
+  outermost_node* prev;
+};
+
+inline outermost_node*& outermost_top() noexcept {
+  static thread_local outermost_node* top = nullptr;
+  return top;
+}
+
+#if defined(_MSC_VER)
+#  define NEARGYE_OUTERMOST_NOINLINE __declspec(noinline)
+#elif defined(__GNUC__) || defined(__clang__)
+#  define NEARGYE_OUTERMOST_NOINLINE __attribute__((noinline))
+#else
+#  define NEARGYE_OUTERMOST_NOINLINE
+#endif
+
+// Not inlined, so compiler does not see the address of the saver on the stack stored in thread-local list.
+NEARGYE_OUTERMOST_NOINLINE inline void outermost_link(outermost_node* node) noexcept {
+  node->prev = outermost_top();
+  outermost_top() = node;
+}
+
+NEARGYE_OUTERMOST_NOINLINE inline void outermost_unlink(outermost_node* node) noexcept {
+  outermost_top() = node->prev;
+}
+
+#undef NEARGYE_OUTERMOST_NOINLINE
+
+template <typename P>
+struct policy_id {
+  static const char id;
+};
+
+template <typename P>
+const char policy_id<P>::id = 0;
+
+inline bool outermost_covered(const void* object, const void* policy) noexcept {
+  for (const outermost_node* n = outermost_top(); n != nullptr; n = n->prev) {
+    if (n->object == object && n->policy == policy) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Saves the object only if no enclosing saver with the same policy on this thread saves it already, otherwise it is no-op.
+template <typename U, typename P>
+class outermost_saver {
+  using T = typename std::remove_reference<U>::type;
+  using assignable_t = typename assignable<T>::type;
+
+  static_assert(!std::is_const<T>::value,
+                "outermost_saver requires not const type.");
+  static_assert(!std::is_rvalue_reference<U>::value && (std::is_lvalue_reference<U>::value || std::is_same<T, U>::value),
+                "outermost_saver requires lvalue type.");
+  static_assert(!std::is_array<T>::value,
+                "outermost_saver requires not array type.");
+  static_assert(std::is_constructible<T, T&>::value,
+                "outermost_saver requires copy constructible.");
+  static_assert(std::is_assignable<T&, assignable_t>::value,
+                "outermost_saver requires operator=.");
+  static_assert(is_policy<P>::value,
+                "outermost_saver requires policy with explicit P(bool) noexcept, dismiss() noexcept and should_execute() const noexcept.");
+#if defined(STATE_SAVER_NO_THROW_RESTORE)
+  static_assert(std::is_nothrow_assignable<T&, assignable_t>::value,
+                "outermost_saver requires noexcept operator=.");
+#endif
+#if defined(STATE_SAVER_NO_THROW_CONSTRUCTIBLE)
+  static_assert(std::is_nothrow_constructible<T, T&>::value,
+                "outermost_saver requires nothrow constructible.");
+#endif
+
+  bool active_;
+  P policy_;
+  T& previous_ref_;
+  outermost_node node_;
+  union {
+    T previous_value_; // Constructed only by the outermost saver.
+  };
+
+  // Destroys the saved value and unregisters the saver, even if restore throws.
+  class release_guard {
+    outermost_saver& saver_;
+
+   public:
+    explicit release_guard(outermost_saver& saver) noexcept : saver_{saver} {}
+
+    ~release_guard() noexcept {
+      if (saver_.active_) {
+        saver_.previous_value_.~T();
+        outermost_unlink(&saver_.node_);
+      }
+    }
+  };
+
+ public:
+  outermost_saver() = delete;
+  outermost_saver(const outermost_saver&) = delete;
+  outermost_saver(outermost_saver&&) = delete;
+  outermost_saver& operator=(const outermost_saver&) = delete;
+  outermost_saver& operator=(outermost_saver&&) = delete;
+
+  outermost_saver(T&&) = delete;
+  outermost_saver(const T&) = delete;
+
+  explicit outermost_saver(T& object) noexcept(std::is_nothrow_constructible<T, T&>::value)
+      : active_{!outermost_covered(std::addressof(object), &policy_id<P>::id)},
+        policy_{active_},
+        previous_ref_{object},
+        node_{std::addressof(object), &policy_id<P>::id, nullptr} {
+    if (active_) {
+      ::new (static_cast<void*>(std::addressof(previous_value_))) T(object);
+      outermost_link(&node_);
+    }
+  }
+
+  // Returns false if enclosing saver covers the object and this one does nothing.
+  bool active() const noexcept {
+    return active_;
+  }
+
+  void dismiss() noexcept {
+    policy_.dismiss();
+  }
+
+  void restore() noexcept(is_noexcept_restore<std::is_nothrow_assignable<T&, T&>::value>::value) {
+#if defined(STATE_SAVER_NO_THROW_RESTORE)
+    static_assert(std::is_nothrow_assignable<T&, T&>::value, "outermost_saver::restore requires noexcept copy operator=.");
+#endif
+    if (active_) {
+      invoke_restore([this]() { previous_ref_ = previous_value_; });
+    }
+  }
+
+  ~outermost_saver() noexcept(is_noexcept_restore<std::is_nothrow_assignable<T&, assignable_t>::value>::value) {
+    release_guard guard{*this};
+    if (active_ && policy_.should_execute()) {
+      invoke_restore([this]() { previous_ref_ = static_cast<assignable_t>(previous_value_); });
+    }
+  }
+};
+
+} // namespace state_saver::detail
+
+// saver_exit_outermost saves the original variable value and restores on scope exit, nested savers of the same variable are no-op.
+template <typename U>
+class saver_exit_outermost : public detail::outermost_saver<U, detail::on_exit_policy> {
+ public:
+  using detail::outermost_saver<U, detail::on_exit_policy>::outermost_saver;
+};
+
+// saver_fail_outermost saves the original variable value and restores on scope exit when an exception has been thrown, nested savers of the same variable are no-op.
+template <typename U>
+class saver_fail_outermost : public detail::outermost_saver<U, detail::on_fail_policy> {
+ public:
+  using detail::outermost_saver<U, detail::on_fail_policy>::outermost_saver;
+};
+
+// saver_success_outermost saves the original variable value and restores on scope exit when no exceptions have been thrown, nested savers of the same variable are no-op.
+template <typename U>
+class saver_success_outermost : public detail::outermost_saver<U, detail::on_success_policy> {
+ public:
+  using detail::outermost_saver<U, detail::on_success_policy>::outermost_saver;
+};
+
+#if defined(__cpp_deduction_guides) && __cpp_deduction_guides >= 201611L
+template <typename U>
+saver_exit_outermost(U&) -> saver_exit_outermost<U>;
+
+template <typename U>
+saver_fail_outermost(U&) -> saver_fail_outermost<U>;
+
+template <typename U>
+saver_success_outermost(U&) -> saver_success_outermost<U>;
+#endif
+
+} // namespace state_saver
+
+// SAVER_EXIT_OUTERMOST saves the original variable value and restores on scope exit, nested savers of the same variable are no-op.
+#define MAKE_SAVER_EXIT_OUTERMOST(name, x) ::state_saver::saver_exit_outermost<decltype(x)> name{x}
+#define SAVER_EXIT_OUTERMOST(x) NEARGYE_MAYBE_UNUSED const MAKE_SAVER_EXIT_OUTERMOST(NEARGYE_STR_CONCAT(SAVER_EXIT_OUTERMOST_, NEARGYE_COUNTER), x)
+#define WITH_SAVER_EXIT_OUTERMOST(x) NEARGYE_STATE_SAVER_WITH(SAVER_EXIT_OUTERMOST(x))
+
+// SAVER_FAIL_OUTERMOST saves the original variable value and restores on scope exit when an exception has been thrown, nested savers of the same variable are no-op.
+#define MAKE_SAVER_FAIL_OUTERMOST(name, x) ::state_saver::saver_fail_outermost<decltype(x)> name{x}
+#define SAVER_FAIL_OUTERMOST(x) NEARGYE_MAYBE_UNUSED const MAKE_SAVER_FAIL_OUTERMOST(NEARGYE_STR_CONCAT(SAVER_FAIL_OUTERMOST_, NEARGYE_COUNTER), x)
+#define WITH_SAVER_FAIL_OUTERMOST(x) NEARGYE_STATE_SAVER_WITH(SAVER_FAIL_OUTERMOST(x))
+
+// SAVER_SUCCESS_OUTERMOST saves the original variable value and restores on scope exit when no exceptions have been thrown, nested savers of the same variable are no-op.
+#define MAKE_SAVER_SUCCESS_OUTERMOST(name, x) ::state_saver::saver_success_outermost<decltype(x)> name{x}
+#define SAVER_SUCCESS_OUTERMOST(x) NEARGYE_MAYBE_UNUSED const MAKE_SAVER_SUCCESS_OUTERMOST(NEARGYE_STR_CONCAT(SAVER_SUCCESS_OUTERMOST_, NEARGYE_COUNTER), x)
+#define WITH_SAVER_SUCCESS_OUTERMOST(x) NEARGYE_STATE_SAVER_WITH(SAVER_SUCCESS_OUTERMOST(x))
+
+#endif // NEARGYE_STATE_SAVER_OUTERMOST_HPP
@@ -0,0 +1,225 @@
+//   _____ _        _          _____                         _____
+//  / ____| |      | |        / ____|                       / ____|_     _
+// | (___ | |_ __ _| |_ ___  | (___   __ ___   _____ _ __  | |   _| |_ _| |_
+//  \___ \| __/ _` | __/ _ \  \___ \ / _` \ \ / / _ \ '__| | |  |_   _|_   _|
+//  ____) | || (_| | ||  __/  ____) | (_| |\ V /  __/ |    | |____|_|   |_|
+// |_____/ \__\__,_|\__\___| |_____/ \__,_| \_/ \___|_|     \_____|
+// https://github.com/Neargye/state_saver
+// version 0.9.0
+//
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NEARGYE_STATE_SAVER_PMR_HPP
+#define NEARGYE_STATE_SAVER_PMR_HPP
+
+#include "state_saver.hpp"
+
+#if defined(__has_include)
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#if defined(__cpp_lib_memory_resource) && __cpp_lib_memory_resource >= 201603L
+#define NEARGYE_STATE_SAVER_PMR 1
+#endif
+#endif
+#endif
+
+#if defined(NEARGYE_STATE_SAVER_PMR)
+
+#include <cstddef>
+#include <cstring>
+
+namespace state_saver {
+
+namespace detail {
+
+inline std::pmr::memory_resource*& thread_resource() noexcept {
+  static thread_local std::pmr::memory_resource* resource = nullptr;
+  return resource;
+}
+
+// Forwards to the resource of the current thread, or to upstream if the thread has none.
+// Each block remembers the resource it was allocated from, so it can be deallocated after the thread resource changed or on other thread.
+class thread_default_resource_t : public std::pmr::memory_resource {
+  std::pmr::memory_resource* upstream_;
+
+  static std::size_t header_size(std::size_t alignment) noexcept {
+    return alignment > sizeof(std::pmr::memory_resource*) ? alignment : sizeof(std::pmr::memory_resource*);
+  }
+
+  static std::size_t header_alignment(std::size_t alignment) noexcept {
+    return alignment > alignof(std::pmr::memory_resource*) ? alignment : alignof(std::pmr::memory_resource*);
+  }
+
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+    std::pmr::memory_resource* resource = thread_resource() != nullptr ? thread_resource() : upstream_;
+    const std::size_t header = header_size(alignment);
+    char* p = static_cast<char*>(resource->allocate(bytes + header, header_alignment(alignment)));
+    std::memcpy(p + header - sizeof(resource), &resource, sizeof(resource));
+    return p + header;
+  }
+
+  void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override {
+    const std::size_t header = header_size(alignment);
+    char* p = static_cast<char*>(ptr) - header;
+    std::pmr::memory_resource* resource = nullptr;
+    std::memcpy(&resource, p + header - sizeof(resource), sizeof(resource));
+    resource->deallocate(p, bytes + header, header_alignment(alignment));
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+
+ public:
+  explicit thread_default_resource_t(std::pmr::memory_resource* upstream) noexcept : upstream_{upstream} {}
+
+  std::pmr::memory_resource* upstream() const noexcept {
+    return upstream_;
+  }
+};
+
+template <typename P>
+class default_resource_saver {
+  static_assert(is_policy<P>::value,
+                "default_resource_saver requires policy with explicit P(bool) noexcept, dismiss() noexcept and should_execute() const noexcept.");
+
+  P policy_;
+  std::pmr::memory_resource* previous_value_;
+
+ public:
+  default_resource_saver() = delete;
+  default_resource_saver(const default_resource_saver&) = delete;
+  default_resource_saver(default_resource_saver&&) = delete;
+  default_resource_saver& operator=(const default_resource_saver&) = delete;
+  default_resource_saver& operator=(default_resource_saver&&) = delete;
+
+  explicit default_resource_saver(std::pmr::memory_resource* resource) noexcept
+      : policy_{true},
+        previous_value_{std::pmr::set_default_resource(resource)} {}
+
+  void dismiss() noexcept {
+    policy_.dismiss();
+  }
+
+  void restore() noexcept {
+    std::pmr::set_default_resource(previous_value_);
+  }
+
+  ~default_resource_saver() noexcept {
+    if (policy_.should_execute()) {
+      restore();
+    }
+  }
+};
+
+template <typename P>
+class thread_resource_saver {
+  static_assert(is_policy<P>::value,
+                "thread_resource_saver requires policy with explicit P(bool) noexcept, dismiss() noexcept and should_execute() const noexcept.");
+
+  P policy_;
+  std::pmr::memory_resource* previous_value_;
+
+ public:
+  thread_resource_saver() = delete;
+  thread_resource_saver(const thread_resource_saver&) = delete;
+  thread_resource_saver(thread_resource_saver&&) = delete;
+  thread_resource_saver& operator=(const thread_resource_saver&) = delete;
+  thread_resource_saver& operator=(thread_resource_saver&&) = delete;
+
+  explicit thread_resource_saver(std::pmr::memory_resource* resource) noexcept
+      : policy_{true},
+        previous_value_{thread_resource()} {
+    thread_resource() = resource;
+  }
+
+  void dismiss() noexcept {
+    policy_.dismiss();
+  }
+
+  void restore() noexcept {
+    thread_resource() = previous_value_;
+  }
+
+  ~thread_resource_saver() noexcept {
+    if (policy_.should_execute()) {
+      restore();
+    }
+  }
+};
+
+} // namespace state_saver::detail
+
+// Resource which forwards to the resource set for the current thread by thread resource savers.
+// Install it as default once with install_thread_default_resource().
+inline std::pmr::memory_resource* thread_default_resource() noexcept {
+  static detail::thread_default_resource_t resource{std::pmr::get_default_resource()};
+  return &resource;
+}
+
+// Sets thread_default_resource() as default resource, returns previous default resource.
+inline std::pmr::memory_resource* install_thread_default_resource() noexcept {
+  return std::pmr::set_default_resource(thread_default_resource());
+}
+
+// saver_exit_default_resource sets the process-wide default resource and restores the previous one on scope exit.
+class saver_exit_default_resource : public detail::default_resource_saver<detail::on_exit_policy> {
+ public:
+  using detail::default_resource_saver<detail::on_exit_policy>::default_resource_saver;
+};
+
+// saver_fail_default_resource sets the process-wide default resource and restores the previous one on scope exit when an exception has been thrown.
+class saver_fail_default_resource : public detail::default_resource_saver<detail::on_fail_policy> {
+ public:
+  using detail::default_resource_saver<detail::on_fail_policy>::default_resource_saver;
+};
+
+// saver_success_default_resource sets the process-wide default resource and restores the previous one on scope exit when no exceptions have been thrown.
+class saver_success_default_resource : public detail::default_resource_saver<detail::on_success_policy> {
+ public:
+  using detail::default_resource_saver<detail::on_success_policy>::default_resource_saver;
+};
+
+// saver_exit_thread_resource sets the default resource of the current thread and restores the previous one on scope exit.
+class saver_exit_thread_resource : public detail::thread_resource_saver<detail::on_exit_policy> {
+ public:
+  using detail::thread_resource_saver<detail::on_exit_policy>::thread_resource_saver;
+};
+
+// saver_fail_thread_resource sets the default resource of the current thread and restores the previous one on scope exit when an exception has been thrown.
+class saver_fail_thread_resource : public detail::thread_resource_saver<detail::on_fail_policy> {
+ public:
+  using detail::thread_resource_saver<detail::on_fail_policy>::thread_resource_saver;
+};
+
+// saver_success_thread_resource sets the default resource of the current thread and restores the previous one on scope exit when no exceptions have been thrown.
+class saver_success_thread_resource : public detail::thread_resource_saver<detail::on_success_policy> {
+ public:
+  using detail::thread_resource_saver<detail::on_success_policy>::thread_resource_saver;
+};
+
+} // namespace state_saver
+
+#endif // NEARGYE_STATE_SAVER_PMR
+
+#endif // NEARGYE_STATE_SAVER_PMR_HPP
@@ -0,0 +1,346 @@
+//   _____ _        _          _____                         _____
+//  / ____| |      | |        / ____|                       / ____|_     _
+// | (___ | |_ __ _| |_ ___  | (___   __ ___   _____ _ __  | |   _| |_ _| |_
+//  \___ \| __/ _` | __/ _ \  \___ \ / _` \ \ / / _ \ '__| | |  |_   _|_   _|
+//  ____) | || (_| | ||  __/  ____) | (_| |\ V /  __/ |    | |____|_|   |_|
+// |_____/ \__\__,_|\__\___| |_____/ \__,_| \_/ \___|_|     \_____|
+// https://github.com/Neargye/state_saver
+// version 0.9.0
+//
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NEARGYE_STATE_SAVER_SAVEPOINT_HPP
+#define NEARGYE_STATE_SAVER_SAVEPOINT_HPP
+
+#include "state_saver.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace state_saver {
+
+namespace detail {
+
+struct record_ops {
+  void (*copy_to)(void* object, void* value);
+  void (*move_to)(void* object, void* value);
+  void (*relocate)(void* from, void* to);
+  void (*destroy)(void* value) noexcept;
+};
+
+template <typename T>
+struct record_ops_for {
+  static void copy_to(void* object, void* value) {
+    *static_cast<T*>(object) = *static_cast<T*>(value);
+  }
+
+  static void move_to(void* object, void* value) {
+    *static_cast<T*>(object) = static_cast<typename assignable<T>::type>(*static_cast<T*>(value));
+  }
+
+  static void relocate(void* from, void* to) {
+    ::new (to) T(std::move_if_noexcept(*static_cast<T*>(from)));
+    static_cast<T*>(from)->~T();
+  }
+
+  static void destroy(void* value) noexcept {
+    static_cast<T*>(value)->~T();
+  }
+
+  static const record_ops ops;
+};
+
+template <typename T>
+const record_ops record_ops_for<T>::ops = {&copy_to, &move_to, &relocate, &destroy};
+
+// Contiguous stack of type-erased saved values, shared by all savepoints.
+class record_stack {
+  static constexpr std::size_t align = alignof(std::max_align_t);
+  static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+  struct record {
+    void* object;
+    const record_ops* ops;
+    std::size_t size;
+    std::size_t prev;
+  };
+
+  static constexpr std::size_t aligned(std::size_t size) noexcept {
+    return (size + align - 1) / align * align;
+  }
+
+  static constexpr std::size_t header_size = (sizeof(record) + align - 1) / align * align;
+
+  std::unique_ptr<std::max_align_t[]> buffer_;
+  std::size_t capacity_;
+  std::size_t size_;
+  std::size_t last_;
+
+  unsigned char* data() const noexcept {
+    return reinterpret_cast<unsigned char*>(buffer_.get());
+  }
+
+  record& at(std::size_t offset) const noexcept {
+    return *reinterpret_cast<record*>(data() + offset);
+  }
+
+  void* value(std::size_t offset) const noexcept {
+    return data() + offset + header_size;
+  }
+
+  // Moves records into the new buffer, values are relocated with their move constructors.
+  void grow(std::size_t required) {
+    std::size_t capacity = capacity_ == 0 ? 16 * align : capacity_ * 2;
+    while (capacity < required) {
+      capacity *= 2;
+    }
+    std::unique_ptr<std::max_align_t[]> buffer{new std::max_align_t[(capacity + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t)]};
+    auto* to = reinterpret_cast<unsigned char*>(buffer.get());
+    for (std::size_t offset = 0; offset < size_; offset += at(offset).size) {
+      ::new (to + offset) record(at(offset));
+      if (at(offset).ops == nullptr) {
+        continue;
+      }
+      try {
+        at(offset).ops->relocate(value(offset), to + offset + header_size);
+      } catch (...) {
+        for (std::size_t moved = 0; moved < offset; moved += at(moved).size) {
+          if (at(moved).ops != nullptr) {
+            at(moved).ops->relocate(to + moved + header_size, value(moved)); // Move back to the old buffer.
+          }
+        }
+        throw;
+      }
+    }
+    buffer_ = std::move(buffer);
+    capacity_ = capacity;
+  }
+
+  bool saved_below(const void* object, std::size_t mark) const noexcept {
+    for (std::size_t offset = 0; offset < mark; offset += at(offset).size) {
+      if (at(offset).object == object && at(offset).ops != nullptr) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+ public:
+  record_stack(const record_stack&) = delete;
+  record_stack& operator=(const record_stack&) = delete;
+
+  record_stack() noexcept : buffer_{}, capacity_{0}, size_{0}, last_{npos} {}
+
+  template <typename T>
+  void push(T& object) {
+    static_assert(alignof(T) <= alignof(std::max_align_t),
+                  "savepoint_saver requires type with alignment not greater than std::max_align_t.");
+    const std::size_t size = header_size + aligned(sizeof(T));
+    if (capacity_ - size_ < size) {
+      grow(size_ + size);
+    }
+    ::new (value(size_)) T(object);
+    ::new (data() + size_) record{std::addressof(object), &record_ops_for<T>::ops, size, last_};
+    last_ = size_;
+    size_ += size;
+  }
+
+  std::size_t size() const noexcept {
+    return size_;
+  }
+
+  // Restores objects saved after mark in reverse order, the records are kept.
+  void restore(std::size_t mark) const {
+    for (std::size_t offset = last_; offset != npos && offset >= mark; offset = at(offset).prev) {
+      if (at(offset).ops != nullptr) {
+        at(offset).ops->copy_to(at(offset).object, value(offset));
+      }
+    }
+  }
+
+  // Restores objects saved after mark in reverse order and pops their records.
+  void rollback(std::size_t mark) {
+    while (last_ != npos && last_ >= mark) {
+      record& r = at(last_);
+      const std::size_t offset = last_;
+      last_ = r.prev;
+      size_ = offset;
+      if (r.ops == nullptr) {
+        continue;
+      }
+      try {
+        r.ops->move_to(r.object, value(offset));
+      } catch (...) {
+        r.ops->destroy(value(offset));
+        throw;
+      }
+      r.ops->destroy(value(offset));
+    }
+  }
+
+  // Drops records after mark of objects already saved before mark, the oldest value is enough for rollback.
+  // Dropped records stay in the stack as tombstones until they are on its top.
+  void release(std::size_t mark) noexcept {
+    for (std::size_t offset = mark; offset < size_; offset += at(offset).size) {
+      record& r = at(offset);
+      if (r.ops != nullptr && saved_below(r.object, mark)) {
+        r.ops->destroy(value(offset));
+        r.ops = nullptr;
+      }
+    }
+    while (last_ != npos && at(last_).ops == nullptr) {
+      size_ = last_;
+      last_ = at(last_).prev;
+    }
+  }
+
+  void clear() noexcept {
+    for (std::size_t offset = 0; offset < size_; offset += at(offset).size) {
+      if (at(offset).ops != nullptr) {
+        at(offset).ops->destroy(value(offset));
+      }
+    }
+    size_ = 0;
+    last_ = npos;
+  }
+
+  ~record_stack() noexcept {
+    clear();
+  }
+};
+
+// Saves group of objects in one contiguous stack, savepoint() is an index into it.
+template <typename P>
+class savepoint_saver {
+  static_assert(is_policy<P>::value,
+                "savepoint_saver requires policy with explicit P(bool) noexcept, dismiss() noexcept and should_execute() const noexcept.");
+
+  // Saved types are checked by save_all, so with STATE_SAVER_NO_THROW_RESTORE restore of the stack does not throw.
+#if defined(STATE_SAVER_NO_THROW_RESTORE)
+  static constexpr bool nothrow_restore = true;
+#else
+  static constexpr bool nothrow_restore = false;
+#endif
+
+  P policy_;
+  record_stack records_;
+
+  void save_all() noexcept {}
+
+  template <typename T, typename... Ts>
+  void save_all(T& object, Ts&... objects) {
+    static_assert(!std::is_const<T>::value, "savepoint_saver requires not const type.");
+    static_assert(std::is_constructible<T, T&>::value, "savepoint_saver requires copy constructible.");
+    static_assert(std::is_assignable<T&, T&>::value, "savepoint_saver requires copy operator=.");
+#if defined(STATE_SAVER_NO_THROW_RESTORE)
+    static_assert(std::is_nothrow_assignable<T&, T&>::value && std::is_nothrow_assignable<T&, typename assignable<T>::type>::value,
+                  "savepoint_saver requires noexcept copy and move operator=.");
+#endif
+#if defined(STATE_SAVER_NO_THROW_CONSTRUCTIBLE)
+    static_assert(std::is_nothrow_constructible<T, T&>::value, "savepoint_saver requires nothrow constructible.");
+#endif
+    records_.push(object);
+    save_all(objects...);
+  }
+
+ public:
+  using savepoint_type = std::size_t;
+
+  savepoint_saver(const savepoint_saver&) = delete;
+  savepoint_saver(savepoint_saver&&) = delete;
+  savepoint_saver& operator=(const savepoint_saver&) = delete;
+  savepoint_saver& operator=(savepoint_saver&&) = delete;
+
+  template <typename... Ts>
+  explicit savepoint_saver(Ts&... objects) : policy_{true}, records_{} {
+    save_all(objects...);
+  }
+
+  // Saves objects before they are modified, each object should be saved once after each savepoint.
+  template <typename... Ts>
+  void save(Ts&... objects) {
+    save_all(objects...);
+  }
+
+  savepoint_type savepoint() const noexcept {
+    return records_.size();
+  }
+
+  // Restores objects saved after the savepoint, later savepoints become invalid.
+  void rollback_to(savepoint_type sp) {
+    if (sp > records_.size()) {
+      throw std::out_of_range{"savepoint_saver::rollback_to invalid savepoint."};
+    }
+    records_.rollback(sp);
+  }
+
+  // Keeps changes after the savepoint as part of the enclosing scope, later savepoints become invalid.
+  void release(savepoint_type sp) {
+    if (sp > records_.size()) {
+      throw std::out_of_range{"savepoint_saver::release invalid savepoint."};
+    }
+    records_.release(sp);
+  }
+
+  void dismiss() noexcept {
+    policy_.dismiss();
+  }
+
+  void restore() noexcept(is_noexcept_restore<nothrow_restore>::value) {
+    invoke_restore([this]() { records_.restore(0); });
+  }
+
+  ~savepoint_saver() noexcept(is_noexcept_restore<nothrow_restore>::value) {
+    if (policy_.should_execute()) {
+      invoke_restore([this]() { records_.rollback(0); });
+    }
+  }
+};
+
+} // namespace state_saver::detail
+
+// saver_exit_transaction saves group of objects with savepoints and restores all on scope exit.
+class saver_exit_transaction : public detail::savepoint_saver<detail::on_exit_policy> {
+ public:
+  using detail::savepoint_saver<detail::on_exit_policy>::savepoint_saver;
+};
+
+// saver_fail_transaction saves group of objects with savepoints and restores all on scope exit when an exception has been thrown.
+class saver_fail_transaction : public detail::savepoint_saver<detail::on_fail_policy> {
+ public:
+  using detail::savepoint_saver<detail::on_fail_policy>::savepoint_saver;
+};
+
+// saver_success_transaction saves group of objects with savepoints and restores all on scope exit when no exceptions have been thrown.
+class saver_success_transaction : public detail::savepoint_saver<detail::on_success_policy> {
+ public:
+  using detail::savepoint_saver<detail::on_success_policy>::savepoint_saver;
+};
+
+} // namespace state_saver
+
+#endif // NEARGYE_STATE_SAVER_SAVEPOINT_HPP
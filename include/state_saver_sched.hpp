@@ -0,0 +1,262 @@
+//   _____ _        _          _____                         _____
+//  / ____| |      | |        / ____|                       / ____|_     _
+// | (___ | |_ __ _| |_ ___  | (___   __ ___   _____ _ __  | |   _| |_ _| |_
+//  \___ \| __/ _` | __/ _ \  \___ \ / _` \ \ / / _ \ '__| | |  |_   _|_   _|
+//  ____) | || (_| | ||  __/  ____) | (_| |\ V /  __/ |    | |____|_|   |_|
+// |_____/ \__\__,_|\__\___| |_____/ \__,_| \_/ \___|_|     \_____|
+// https://github.com/Neargye/state_saver
+// version 0.9.0
+//
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NEARGYE_STATE_SAVER_SCHED_HPP
+#define NEARGYE_STATE_SAVER_SCHED_HPP
+
+#include "state_saver.hpp"
+
+#if defined(__linux__)
+
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+#include <sched.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace state_saver {
+
+// Scheduling policy, parameters and nice value of a thread.
+struct sched_state {
+  int policy;
+  sched_param param;
+  int nice;
+};
+
+namespace detail {
+
+[[noreturn]] inline void throw_sched_error(const char* what) {
+  throw std::system_error{errno, std::system_category(), what};
+}
+
+inline id_t current_tid() noexcept {
+  return static_cast<id_t>(::syscall(SYS_gettid));
+}
+
+struct affinity_traits {
+  using value_type = cpu_set_t;
+
+  static value_type get() {
+    value_type value;
+    CPU_ZERO(&value);
+    if (::sched_getaffinity(0, sizeof(value), &value) != 0) {
+      throw_sched_error("sched_getaffinity");
+    }
+    return value;
+  }
+
+  static void set(const value_type& value) {
+    if (::sched_setaffinity(0, sizeof(value), &value) != 0) {
+      throw_sched_error("sched_setaffinity");
+    }
+  }
+
+  static bool equal(const value_type& lhs, const value_type& rhs) noexcept {
+    return CPU_EQUAL(&lhs, &rhs);
+  }
+};
+
+struct sched_traits {
+  using value_type = sched_state;
+
+  static value_type get() {
+    value_type value;
+    std::memset(&value, 0, sizeof(value));
+    value.policy = ::sched_getscheduler(0);
+    if (value.policy == -1) {
+      throw_sched_error("sched_getscheduler");
+    }
+    if (::sched_getparam(0, &value.param) != 0) {
+      throw_sched_error("sched_getparam");
+    }
+    errno = 0;
+    value.nice = ::getpriority(PRIO_PROCESS, current_tid());
+    if (value.nice == -1 && errno != 0) {
+      throw_sched_error("getpriority");
+    }
+    return value;
+  }
+
+  static void set(const value_type& value) {
+    if (::sched_setscheduler(0, value.policy, &value.param) != 0) {
+      throw_sched_error("sched_setscheduler");
+    }
+    if (::setpriority(PRIO_PROCESS, current_tid(), value.nice) != 0) {
+      throw_sched_error("setpriority");
+    }
+  }
+
+  static bool equal(const value_type& lhs, const value_type& rhs) noexcept {
+    return lhs.policy == rhs.policy && lhs.param.sched_priority == rhs.param.sched_priority && lhs.nice == rhs.nice;
+  }
+};
+
+struct timer_slack_traits {
+  using value_type = unsigned long;
+
+  static value_type get() {
+    const int value = ::prctl(PR_GET_TIMERSLACK, 0, 0, 0, 0);
+    if (value == -1) {
+      throw_sched_error("prctl(PR_GET_TIMERSLACK)");
+    }
+    return static_cast<value_type>(value);
+  }
+
+  static void set(value_type value) {
+    if (::prctl(PR_SET_TIMERSLACK, value, 0, 0, 0) != 0) {
+      throw_sched_error("prctl(PR_SET_TIMERSLACK)");
+    }
+  }
+
+  static bool equal(value_type lhs, value_type rhs) noexcept {
+    return lhs == rhs;
+  }
+};
+
+// Saves thread attribute described by Traits.
+// Saver created with desired value restores only if it changed the attribute, no syscall is made to read it back,
+// so changes made in the scope by other code after a no-op override are not undone.
+template <typename Traits, typename P>
+class thread_attribute_saver {
+  using T = typename Traits::value_type;
+
+  static_assert(is_policy<P>::value,
+                "thread_attribute_saver requires policy with explicit P(bool) noexcept, dismiss() noexcept and should_execute() const noexcept.");
+
+  P policy_;
+  T previous_value_;
+  bool changed_;
+
+ public:
+  thread_attribute_saver(const thread_attribute_saver&) = delete;
+  thread_attribute_saver(thread_attribute_saver&&) = delete;
+  thread_attribute_saver& operator=(const thread_attribute_saver&) = delete;
+  thread_attribute_saver& operator=(thread_attribute_saver&&) = delete;
+
+  // Saves the current value of the calling thread.
+  thread_attribute_saver() : policy_{true}, previous_value_(Traits::get()), changed_{true} {}
+
+  // Saves the current value of the calling thread and sets desired.
+  explicit thread_attribute_saver(const T& desired)
+      : policy_{true},
+        previous_value_(Traits::get()),
+        changed_{!Traits::equal(previous_value_, desired)} {
+    if (changed_) {
+      Traits::set(desired);
+    }
+  }
+
+  const T& previous_value() const noexcept {
+    return previous_value_;
+  }
+
+  void dismiss() noexcept {
+    policy_.dismiss();
+  }
+
+  void restore() {
+    if (changed_) {
+      Traits::set(previous_value_);
+    }
+  }
+
+  ~thread_attribute_saver() noexcept(is_noexcept_restore<false>::value) {
+    if (policy_.should_execute()) {
+      invoke_restore([this]() { restore(); });
+    }
+  }
+};
+
+} // namespace state_saver::detail
+
+// saver_exit_affinity saves CPU affinity of the calling thread and restores on scope exit.
+class saver_exit_affinity : public detail::thread_attribute_saver<detail::affinity_traits, detail::on_exit_policy> {
+ public:
+  using detail::thread_attribute_saver<detail::affinity_traits, detail::on_exit_policy>::thread_attribute_saver;
+};
+
+// saver_fail_affinity saves CPU affinity of the calling thread and restores on scope exit when an exception has been thrown.
+class saver_fail_affinity : public detail::thread_attribute_saver<detail::affinity_traits, detail::on_fail_policy> {
+ public:
+  using detail::thread_attribute_saver<detail::affinity_traits, detail::on_fail_policy>::thread_attribute_saver;
+};
+
+// saver_success_affinity saves CPU affinity of the calling thread and restores on scope exit when no exceptions have been thrown.
+class saver_success_affinity : public detail::thread_attribute_saver<detail::affinity_traits, detail::on_success_policy> {
+ public:
+  using detail::thread_attribute_saver<detail::affinity_traits, detail::on_success_policy>::thread_attribute_saver;
+};
+
+// saver_exit_sched saves scheduling policy, parameters and nice value of the calling thread and restores on scope exit.
+class saver_exit_sched : public detail::thread_attribute_saver<detail::sched_traits, detail::on_exit_policy> {
+ public:
+  using detail::thread_attribute_saver<detail::sched_traits, detail::on_exit_policy>::thread_attribute_saver;
+};
+
+// saver_fail_sched saves scheduling policy, parameters and nice value of the calling thread and restores on scope exit when an exception has been thrown.
+class saver_fail_sched : public detail::thread_attribute_saver<detail::sched_traits, detail::on_fail_policy> {
+ public:
+  using detail::thread_attribute_saver<detail::sched_traits, detail::on_fail_policy>::thread_attribute_saver;
+};
+
+// saver_success_sched saves scheduling policy, parameters and nice value of the calling thread and restores on scope exit when no exceptions have been thrown.
+class saver_success_sched : public detail::thread_attribute_saver<detail::sched_traits, detail::on_success_policy> {
+ public:
+  using detail::thread_attribute_saver<detail::sched_traits, detail::on_success_policy>::thread_attribute_saver;
+};
+
+// saver_exit_timer_slack saves timer slack of the calling thread and restores on scope exit.
+class saver_exit_timer_slack : public detail::thread_attribute_saver<detail::timer_slack_traits, detail::on_exit_policy> {
+ public:
+  using detail::thread_attribute_saver<detail::timer_slack_traits, detail::on_exit_policy>::thread_attribute_saver;
+};
+
+// saver_fail_timer_slack saves timer slack of the calling thread and restores on scope exit when an exception has been thrown.
+class saver_fail_timer_slack : public detail::thread_attribute_saver<detail::timer_slack_traits, detail::on_fail_policy> {
+ public:
+  using detail::thread_attribute_saver<detail::timer_slack_traits, detail::on_fail_policy>::thread_attribute_saver;
+};
+
+// saver_success_timer_slack saves timer slack of the calling thread and restores on scope exit when no exceptions have been thrown.
+class saver_success_timer_slack : public detail::thread_attribute_saver<detail::timer_slack_traits, detail::on_success_policy> {
+ public:
+  using detail::thread_attribute_saver<detail::timer_slack_traits, detail::on_success_policy>::thread_attribute_saver;
+};
+
+} // namespace state_saver
+
+#endif // defined(__linux__)
+
+#endif // NEARGYE_STATE_SAVER_SCHED_HPP
@@ -0,0 +1,166 @@
+//   _____ _        _          _____                         _____
+//  / ____| |      | |        / ____|                       / ____|_     _
+// | (___ | |_ __ _| |_ ___  | (___   __ ___   _____ _ __  | |   _| |_ _| |_
+//  \___ \| __/ _` | __/ _ \  \___ \ / _` \ \ / / _ \ '__| | |  |_   _|_   _|
+//  ____) | || (_| | ||  __/  ____) | (_| |\ V /  __/ |    | |____|_|   |_|
+// |_____/ \__\__,_|\__\___| |_____/ \__,_| \_/ \___|_|     \_____|
+// https://github.com/Neargye/state_saver
+// version 0.9.0
+//
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NEARGYE_STATE_SAVER_SMALL_HPP
+#define NEARGYE_STATE_SAVER_SMALL_HPP
+
+#include "state_saver.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace state_saver {
+
+namespace detail {
+
+// Thread-local cache of blocks for heap snapshots, blocks come from operator new, so they may be freed on any thread.
+class snapshot_pool {
+  static constexpr std::size_t min_shift = 6;    // 64 B.
+  static constexpr std::size_t class_count = 16; // Up to 2 MiB.
+  static constexpr std::size_t max_cached = 8;
+
+  struct free_block {
+    free_block* next;
+  };
+
+  free_block* free_[class_count];
+  std::size_t cached_[class_count];
+
+  static std::size_t size_class(std::size_t size) noexcept {
+    std::size_t c = 0;
+    while (c < class_count && (std::size_t{1} << (min_shift + c)) < size) {
+      ++c;
+    }
+    return c;
+  }
+
+ public:
+  snapshot_pool(const snapshot_pool&) = delete;
+  snapshot_pool& operator=(const snapshot_pool&) = delete;
+
+  snapshot_pool() noexcept : free_{}, cached_{} {}
+
+  static snapshot_pool& local() noexcept {
+    static thread_local snapshot_pool pool;
+    return pool;
+  }
+
+  void* allocate(std::size_t size) {
+    const std::size_t c = size_class(size);
+    if (c == class_count) {
+      return ::operator new(size);
+    }
+    if (free_[c] != nullptr) {
+      free_block* block = free_[c];
+      free_[c] = block->next;
+      --cached_[c];
+      return block;
+    }
+    return ::operator new(std::size_t{1} << (min_shift + c));
+  }
+
+  void deallocate(void* p, std::size_t size) noexcept {
+    const std::size_t c = size_class(size);
+    if (c == class_count || cached_[c] == max_cached) {
+      ::operator delete(p);
+      return;
+    }
+    free_[c] = ::new (p) free_block{free_[c]};
+    ++cached_[c];
+  }
+
+  ~snapshot_pool() noexcept {
+    for (std::size_t c = 0; c < class_count; ++c) {
+      while (free_[c] != nullptr) {
+        free_block* block = free_[c];
+        free_[c] = block->next;
+        ::operator delete(block);
+      }
+    }
+  }
+};
+
+// Keeps snapshot in block from the thread-local pool, the saver holds only a pointer.
+template <typename T>
+class heap_snapshot {
+  using assignable_t = typename assignable<T>::type;
+
+  static_assert(alignof(T) <= alignof(std::max_align_t),
+                "small_storage requires type with alignment not greater than std::max_align_t.");
+
+  T* value_;
+
+ public:
+  heap_snapshot(const heap_snapshot&) = delete;
+  heap_snapshot& operator=(const heap_snapshot&) = delete;
+
+  explicit heap_snapshot(T& object) : value_{nullptr} {
+    void* p = snapshot_pool::local().allocate(sizeof(T));
+    try {
+      value_ = ::new (p) T(object);
+    } catch (...) {
+      snapshot_pool::local().deallocate(p, sizeof(T));
+      throw;
+    }
+  }
+
+  void copy_to(T& object) noexcept(std::is_nothrow_assignable<T&, T&>::value) {
+    object = *value_;
+  }
+
+  void move_to(T& object) noexcept(std::is_nothrow_assignable<T&, assignable_t>::value) {
+    object = static_cast<assignable_t>(*value_);
+  }
+
+  ~heap_snapshot() noexcept {
+    value_->~T();
+    snapshot_pool::local().deallocate(value_, sizeof(T));
+  }
+};
+
+} // namespace state_saver::detail
+
+// Keeps snapshots of types with size not greater than Threshold bytes inline, larger ones are spilled to the thread-local pool.
+template <std::size_t Threshold>
+struct basic_small_storage {
+  template <typename T>
+  using snapshot = typename std::conditional<(sizeof(T) <= Threshold),
+                                             inline_storage::snapshot<T>,
+                                             detail::heap_snapshot<T>>::type;
+};
+
+using small_storage = basic_small_storage<256>;
+
+} // namespace state_saver
+
+#endif // NEARGYE_STATE_SAVER_SMALL_HPP
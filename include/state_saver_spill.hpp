@@ -0,0 +1,146 @@
+//   _____ _        _          _____                         _____
+//  / ____| |      | |        / ____|                       / ____|_     _
+// | (___ | |_ __ _| |_ ___  | (___   __ ___   _____ _ __  | |   _| |_ _| |_
+//  \___ \| __/ _` | __/ _ \  \___ \ / _` \ \ / / _ \ '__| | |  |_   _|_   _|
+//  ____) | || (_| | ||  __/  ____) | (_| |\ V /  __/ |    | |____|_|   |_|
+// |_____/ \__\__,_|\__\___| |_____/ \__,_| \_/ \___|_|     \_____|
+// https://github.com/Neargye/state_saver
+// version 0.9.0
+//
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NEARGYE_STATE_SAVER_SPILL_HPP
+#define NEARGYE_STATE_SAVER_SPILL_HPP
+
+#include "state_saver.hpp"
+#include "state_saver_file.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <cstdio>
+#include <type_traits>
+
+#if !defined(STATE_SAVER_SPILL_DIR)
+#  if defined(P_tmpdir)
+#    define STATE_SAVER_SPILL_DIR P_tmpdir
+#  else
+#    define STATE_SAVER_SPILL_DIR "/tmp"
+#  endif
+#endif
+
+namespace state_saver {
+
+// Sequential writer of the snapshot bytes, passed to the snapshot_write customization point.
+class snapshot_writer {
+  int fd_;
+  off_t offset_;
+
+ public:
+  explicit snapshot_writer(int fd) noexcept : fd_{fd}, offset_{0} {}
+
+  void write(const void* data, std::size_t size) {
+    detail::write_at(fd_, static_cast<const unsigned char*>(data), size, offset_);
+    offset_ += static_cast<off_t>(size);
+  }
+};
+
+// Sequential reader of the snapshot bytes, passed to the snapshot_read customization point.
+class snapshot_reader {
+  int fd_;
+  off_t offset_;
+
+ public:
+  explicit snapshot_reader(int fd) noexcept : fd_{fd}, offset_{0} {}
+
+  void read(void* data, std::size_t size) {
+    if (detail::read_at(fd_, static_cast<unsigned char*>(data), size, offset_) != size) {
+      throw std::system_error{std::make_error_code(std::errc::io_error), "snapshot_reader: unexpected end of snapshot."};
+    }
+    offset_ += static_cast<off_t>(size);
+  }
+};
+
+namespace detail {
+
+// Types found by ADL: void snapshot_write(const T&, snapshot_writer&) and void snapshot_read(T&, snapshot_reader&).
+template <typename T, typename = void>
+struct has_snapshot_serialization : std::false_type {};
+
+template <typename T>
+struct has_snapshot_serialization<T, typename make_void<decltype(snapshot_write(std::declval<const T&>(), std::declval<snapshot_writer&>())),
+                                                        decltype(snapshot_read(std::declval<T&>(), std::declval<snapshot_reader&>()))>::type>
+    : std::true_type {};
+
+template <typename T>
+auto spill_write(const T& object, snapshot_writer& writer) -> typename std::enable_if<has_snapshot_serialization<T>::value>::type {
+  snapshot_write(object, writer);
+}
+
+template <typename T>
+auto spill_write(const T& object, snapshot_writer& writer) -> typename std::enable_if<!has_snapshot_serialization<T>::value>::type {
+  writer.write(std::addressof(object), sizeof(T));
+}
+
+template <typename T>
+auto spill_read(T& object, snapshot_reader& reader) -> typename std::enable_if<has_snapshot_serialization<T>::value>::type {
+  snapshot_read(object, reader);
+}
+
+template <typename T>
+auto spill_read(T& object, snapshot_reader& reader) -> typename std::enable_if<!has_snapshot_serialization<T>::value>::type {
+  reader.read(std::addressof(object), sizeof(T));
+}
+
+} // namespace state_saver::detail
+
+// Keeps snapshot in unnamed temporary file (O_TMPFILE on Linux) in STATE_SAVER_SPILL_DIR, it is read back only on restore.
+struct spill_storage {
+  template <typename T>
+  class snapshot {
+    static_assert(std::is_trivially_copyable<T>::value || detail::has_snapshot_serialization<T>::value,
+                  "spill_storage requires trivially copyable type or snapshot_write/snapshot_read customization.");
+
+    detail::file_descriptor file_;
+
+   public:
+    explicit snapshot(T& object) : file_{detail::open_backup_file(STATE_SAVER_SPILL_DIR)} {
+      snapshot_writer writer{file_.get()};
+      detail::spill_write(static_cast<const T&>(object), writer);
+    }
+
+    void copy_to(T& object) {
+      snapshot_reader reader{file_.get()};
+      detail::spill_read(object, reader);
+    }
+
+    void move_to(T& object) {
+      copy_to(object);
+    }
+  };
+};
+
+} // namespace state_saver
+
+#endif // defined(__unix__) || defined(__APPLE__)
+
+#endif // NEARGYE_STATE_SAVER_SPILL_HPP
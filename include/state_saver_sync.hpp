@@ -0,0 +1,733 @@
+//   _____ _        _          _____                         _____
+//  / ____| |      | |        / ____|                       / ____|_     _
+// | (___ | |_ __ _| |_ ___  | (___   __ ___   _____ _ __  | |   _| |_ _| |_
+//  \___ \| __/ _` | __/ _ \  \___ \ / _` \ \ / / _ \ '__| | |  |_   _|_   _|
+//  ____) | || (_| | ||  __/  ____) | (_| |\ V /  __/ |    | |____|_|   |_|
+// |_____/ \__\__,_|\__\___| |_____/ \__,_| \_/ \___|_|     \_____|
+// https://github.com/Neargye/state_saver
+// version 0.9.0
+//
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NEARGYE_STATE_SAVER_SYNC_HPP
+#define NEARGYE_STATE_SAVER_SYNC_HPP
+
+#include "state_saver.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace state_saver {
+
+// seqlocked wraps trivially copyable value, readers take lock-free optimistic snapshots, writers are serialized by sequence counter.
+template <typename T>
+class seqlocked {
+  static_assert(!std::is_const<T>::value,
+                "seqlocked requires not const type.");
+  static_assert(std::is_trivially_copyable<T>::value && std::is_default_constructible<T>::value,
+                "seqlocked requires trivially copyable and default constructible type.");
+
+  using word_t = std::uintptr_t;
+  static constexpr std::size_t words = (sizeof(T) + sizeof(word_t) - 1) / sizeof(word_t);
+
+  std::atomic<std::size_t> sequence_;
+  std::atomic<word_t> data_[words];
+
+  void write(const T& value) noexcept {
+    word_t buffer[words] = {};
+    std::memcpy(buffer, &value, sizeof(T));
+    for (std::size_t i = 0; i < words; ++i) {
+      data_[i].store(buffer[i], std::memory_order_relaxed);
+    }
+  }
+
+  // Only called inside write-side critical section, so no other writer can change data.
+  T read_locked() const noexcept {
+    word_t buffer[words];
+    for (std::size_t i = 0; i < words; ++i) {
+      buffer[i] = data_[i].load(std::memory_order_relaxed);
+    }
+    T value;
+    std::memcpy(&value, buffer, sizeof(T));
+    return value;
+  }
+
+  // Makes sequence odd, returns the even sequence it started from.
+  std::size_t begin_write() noexcept {
+    std::size_t sequence = sequence_.load(std::memory_order_relaxed);
+    while ((sequence & 1) != 0 || !sequence_.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+      sequence = sequence_.load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    return sequence;
+  }
+
+  void end_write(std::size_t sequence) noexcept {
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+ public:
+  seqlocked() noexcept : seqlocked{T{}} {}
+
+  explicit seqlocked(const T& value) noexcept : sequence_{0} {
+    write(value);
+  }
+
+  seqlocked(const seqlocked&) = delete;
+  seqlocked& operator=(const seqlocked&) = delete;
+
+  T load() const noexcept {
+    word_t buffer[words];
+    for (;;) {
+      const std::size_t sequence = sequence_.load(std::memory_order_acquire);
+      if ((sequence & 1) != 0) {
+        continue; // Write in progress.
+      }
+      for (std::size_t i = 0; i < words; ++i) {
+        buffer[i] = data_[i].load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence_.load(std::memory_order_relaxed) == sequence) {
+        break;
+      }
+    }
+    T value;
+    std::memcpy(&value, buffer, sizeof(T));
+    return value;
+  }
+
+  void store(const T& value) noexcept {
+    const std::size_t sequence = begin_write();
+    write(value);
+    end_write(sequence);
+  }
+
+  // Reads and writes inside one write-side critical section, so no concurrent write is lost.
+  T exchange(const T& value) noexcept {
+    const std::size_t sequence = begin_write();
+    T previous = read_locked();
+    write(value);
+    end_write(sequence);
+    return previous;
+  }
+};
+
+namespace detail {
+
+template <typename U, typename P, typename S = typename std::remove_reference<U>::type>
+class seqlock_saver {
+  static_assert(sizeof(S) == 0,
+                "seqlock_saver requires seqlocked type.");
+};
+
+template <typename U, typename P, typename T>
+class seqlock_saver<U, P, seqlocked<T>> {
+  using S = seqlocked<T>;
+
+  static_assert(!std::is_rvalue_reference<U>::value && (std::is_lvalue_reference<U>::value || std::is_same<S, U>::value),
+                "seqlock_saver requires lvalue type.");
+  static_assert(is_policy<P>::value,
+                "seqlock_saver requires policy with explicit P(bool) noexcept, dismiss() noexcept and should_execute() const noexcept.");
+
+  P policy_;
+  S& previous_ref_;
+  T previous_value_;
+
+ public:
+  seqlock_saver() = delete;
+  seqlock_saver(const seqlock_saver&) = delete;
+  seqlock_saver(seqlock_saver&&) = delete;
+  seqlock_saver& operator=(const seqlock_saver&) = delete;
+  seqlock_saver& operator=(seqlock_saver&&) = delete;
+
+  // Saves the current value, on scope exit restores it with seqlock write.
+  explicit seqlock_saver(S& object) noexcept
+      : policy_{true},
+        previous_ref_{object},
+        previous_value_{object.load()} {}
+
+  // Saves the current value and overrides it with desired.
+  seqlock_saver(S& object, const T& desired) noexcept
+      : policy_{true},
+        previous_ref_{object},
+        previous_value_{object.exchange(desired)} {}
+
+  void dismiss() noexcept {
+    policy_.dismiss();
+  }
+
+  void restore() noexcept {
+    previous_ref_.store(previous_value_);
+  }
+
+  ~seqlock_saver() noexcept {
+    if (policy_.should_execute()) {
+      restore();
+    }
+  }
+};
+
+template <typename U, typename P, typename S = typename std::remove_reference<U>::type>
+class shared_ptr_saver {
+  static_assert(sizeof(S) == 0,
+                "shared_ptr_saver requires std::shared_ptr or std::atomic<std::shared_ptr> type.");
+};
+
+// Slot accessed through std::atomic_* free functions for std::shared_ptr.
+// Every read takes reference count and, in some standard libraries, a lock from global pool, prefer rcu_slot on hot read paths.
+template <typename T>
+struct shared_ptr_slot {
+  using pointer = std::shared_ptr<T>;
+
+  static pointer load(const pointer& slot) noexcept {
+    return std::atomic_load(&slot);
+  }
+
+  static void store(pointer& slot, pointer value) noexcept {
+    std::atomic_store(&slot, std::move(value));
+  }
+
+  static pointer exchange(pointer& slot, pointer value) noexcept {
+    return std::atomic_exchange(&slot, std::move(value));
+  }
+
+  static bool compare_exchange(pointer& slot, pointer& expected, pointer value) noexcept {
+    return std::atomic_compare_exchange_strong(&slot, &expected, std::move(value));
+  }
+};
+
+#if defined(__cpp_lib_atomic_shared_ptr) && __cpp_lib_atomic_shared_ptr >= 201711L
+// Slot of std::atomic<std::shared_ptr>.
+template <typename T>
+struct atomic_shared_ptr_slot {
+  using pointer = std::shared_ptr<T>;
+
+  static pointer load(const std::atomic<pointer>& slot) noexcept {
+    return slot.load();
+  }
+
+  static void store(std::atomic<pointer>& slot, pointer value) noexcept {
+    slot.store(std::move(value));
+  }
+
+  static pointer exchange(std::atomic<pointer>& slot, pointer value) noexcept {
+    return slot.exchange(std::move(value));
+  }
+
+  static bool compare_exchange(std::atomic<pointer>& slot, pointer& expected, pointer value) noexcept {
+    return slot.compare_exchange_strong(expected, std::move(value));
+  }
+};
+#endif
+
+// Reader record of the epoch-based reclamation, records are reused by new threads and never freed.
+struct rcu_reader {
+  std::atomic<std::uint64_t> epoch; // 0 if not in read-side critical section.
+  std::atomic<bool> in_use;
+  rcu_reader* next;
+};
+
+inline std::atomic<std::uint64_t>& rcu_epoch() noexcept {
+  static std::atomic<std::uint64_t> epoch{1};
+  return epoch;
+}
+
+inline std::atomic<rcu_reader*>& rcu_readers() noexcept {
+  static std::atomic<rcu_reader*> head{nullptr};
+  return head;
+}
+
+inline rcu_reader* rcu_acquire_reader() {
+  for (rcu_reader* r = rcu_readers().load(std::memory_order_acquire); r != nullptr; r = r->next) {
+    bool expected = false;
+    if (!r->in_use.load(std::memory_order_relaxed) && r->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+      return r;
+    }
+  }
+  rcu_reader* r = new rcu_reader{{0}, {true}, rcu_readers().load(std::memory_order_relaxed)};
+  while (!rcu_readers().compare_exchange_weak(r->next, r, std::memory_order_release, std::memory_order_relaxed)) {}
+  return r;
+}
+
+struct rcu_thread {
+  rcu_reader* reader;
+  unsigned depth;
+
+  rcu_thread() : reader{rcu_acquire_reader()}, depth{0} {}
+
+  rcu_thread(const rcu_thread&) = delete;
+  rcu_thread& operator=(const rcu_thread&) = delete;
+
+  ~rcu_thread() {
+    reader->epoch.store(0, std::memory_order_release);
+    reader->in_use.store(false, std::memory_order_release);
+  }
+};
+
+inline rcu_thread& rcu_this_thread() {
+  static thread_local rcu_thread thread;
+  return thread;
+}
+
+// Smallest epoch announced by readers in read-side critical section.
+inline std::uint64_t rcu_min_reader_epoch() noexcept {
+  std::uint64_t min = static_cast<std::uint64_t>(-1);
+  for (rcu_reader* r = rcu_readers().load(std::memory_order_acquire); r != nullptr; r = r->next) {
+    const std::uint64_t epoch = r->epoch.load(std::memory_order_seq_cst);
+    if (epoch != 0 && epoch < min) {
+      min = epoch;
+    }
+  }
+  return min;
+}
+
+} // namespace state_saver::detail
+
+// rcu_read_guard marks read-side critical section of the current thread, it may be nested.
+// Pointers from rcu_slot::get() stay valid until the guard is destroyed. Readers never block and never touch reference counts.
+class rcu_read_guard {
+  detail::rcu_thread& thread_;
+
+ public:
+  rcu_read_guard() : thread_{detail::rcu_this_thread()} {
+    if (thread_.depth++ == 0) {
+      thread_.reader->epoch.store(detail::rcu_epoch().load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+  }
+
+  rcu_read_guard(const rcu_read_guard&) = delete;
+  rcu_read_guard& operator=(const rcu_read_guard&) = delete;
+
+  ~rcu_read_guard() {
+    if (--thread_.depth == 0) {
+      thread_.reader->epoch.store(0, std::memory_order_release);
+    }
+  }
+};
+
+// rcu_slot publishes std::shared_ptr, readers get raw pointer under rcu_read_guard.
+// Replaced pointers are retired with the current epoch and released after all readers which could see them have left.
+// Writers are serialized by mutex.
+template <typename T>
+class rcu_slot {
+  struct retired {
+    std::uint64_t epoch;
+    std::shared_ptr<T> value;
+  };
+
+  std::atomic<T*> current_;
+  std::shared_ptr<T> owner_;
+  std::vector<retired> retired_;
+  mutable std::mutex mutex_;
+
+  // Must be called under mutex.
+  std::shared_ptr<T> replace(std::shared_ptr<T> value) {
+    current_.store(value.get(), std::memory_order_seq_cst);
+    std::shared_ptr<T> previous = std::move(owner_);
+    owner_ = std::move(value);
+    retired_.push_back({detail::rcu_epoch().fetch_add(1, std::memory_order_seq_cst), previous});
+    reclaim_locked();
+    return previous;
+  }
+
+  void reclaim_locked() noexcept {
+    const std::uint64_t min = detail::rcu_min_reader_epoch();
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < retired_.size(); ++i) {
+      if (retired_[i].epoch >= min) {
+        retired_[kept++] = std::move(retired_[i]);
+      }
+    }
+    retired_.resize(kept);
+  }
+
+ public:
+  explicit rcu_slot(std::shared_ptr<T> value = nullptr) : current_{value.get()}, owner_{std::move(value)}, retired_{}, mutex_{} {}
+
+  rcu_slot(const rcu_slot&) = delete;
+  rcu_slot& operator=(const rcu_slot&) = delete;
+
+  // Lock-free read, must be called under rcu_read_guard.
+  T* get() const noexcept {
+    return current_.load(std::memory_order_seq_cst);
+  }
+
+  // Owning copy of the published pointer, takes writer mutex and reference count.
+  std::shared_ptr<T> load() const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    return owner_;
+  }
+
+  void store(std::shared_ptr<T> value) {
+    exchange(std::move(value));
+  }
+
+  std::shared_ptr<T> exchange(std::shared_ptr<T> value) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    return replace(std::move(value));
+  }
+
+  bool compare_exchange(std::shared_ptr<T>& expected, std::shared_ptr<T> value) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    if (owner_ != expected) {
+      expected = owner_;
+      return false;
+    }
+    replace(std::move(value));
+    return true;
+  }
+
+  // Releases retired pointers which no reader can see anymore, also done on every write.
+  void reclaim() {
+    std::lock_guard<std::mutex> lock{mutex_};
+    reclaim_locked();
+  }
+
+  // Number of retired pointers waiting for readers.
+  std::size_t retired_count() const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    return retired_.size();
+  }
+};
+
+namespace detail {
+
+// Slot of rcu_slot.
+template <typename T>
+struct rcu_shared_ptr_slot {
+  using pointer = std::shared_ptr<T>;
+
+  static pointer load(const rcu_slot<T>& slot) {
+    return slot.load();
+  }
+
+  static void store(rcu_slot<T>& slot, pointer value) {
+    slot.store(std::move(value));
+  }
+
+  static pointer exchange(rcu_slot<T>& slot, pointer value) {
+    return slot.exchange(std::move(value));
+  }
+
+  static bool compare_exchange(rcu_slot<T>& slot, pointer& expected, pointer value) {
+    return slot.compare_exchange(expected, std::move(value));
+  }
+};
+
+template <typename U, typename P, typename S, typename A>
+class basic_shared_ptr_saver {
+  using pointer = typename A::pointer;
+
+  static_assert(!std::is_rvalue_reference<U>::value && (std::is_lvalue_reference<U>::value || std::is_same<S, U>::value),
+                "shared_ptr_saver requires lvalue type.");
+  static_assert(is_policy<P>::value,
+                "shared_ptr_saver requires policy with explicit P(bool) noexcept, dismiss() noexcept and should_execute() const noexcept.");
+
+  static constexpr bool nothrow_restore = noexcept(A::store(std::declval<S&>(), std::declval<pointer>())) &&
+                                            noexcept(A::compare_exchange(std::declval<S&>(), std::declval<pointer&>(), std::declval<pointer>()));
+
+  P policy_;
+  S& previous_ref_;
+  pointer previous_value_;
+  pointer desired_value_;
+  bool conditional_;
+
+ public:
+  basic_shared_ptr_saver() = delete;
+  basic_shared_ptr_saver(const basic_shared_ptr_saver&) = delete;
+  basic_shared_ptr_saver(basic_shared_ptr_saver&&) = delete;
+  basic_shared_ptr_saver& operator=(const basic_shared_ptr_saver&) = delete;
+  basic_shared_ptr_saver& operator=(basic_shared_ptr_saver&&) = delete;
+
+  // Saves the current published pointer, on scope exit publishes it back.
+  explicit basic_shared_ptr_saver(S& slot) noexcept(noexcept(A::load(slot)))
+      : policy_{true},
+        previous_ref_{slot},
+        previous_value_{A::load(slot)},
+        desired_value_{},
+        conditional_{false} {}
+
+  // Publishes desired pointer, on scope exit publishes the saved pointer back only if desired is still published.
+  // The saved pointer is kept alive by the saver, so readers holding it are never invalidated.
+  basic_shared_ptr_saver(S& slot, pointer desired) noexcept(noexcept(A::exchange(slot, desired)))
+      : policy_{true},
+        previous_ref_{slot},
+        previous_value_{A::exchange(slot, desired)},
+        desired_value_{std::move(desired)},
+        conditional_{true} {}
+
+  void dismiss() noexcept {
+    policy_.dismiss();
+  }
+
+  // Returns true if the saved pointer was published.
+  bool restore() noexcept(nothrow_restore) {
+    if (conditional_) {
+      pointer expected = desired_value_;
+      return A::compare_exchange(previous_ref_, expected, previous_value_);
+    }
+    A::store(previous_ref_, previous_value_);
+    return true;
+  }
+
+  ~basic_shared_ptr_saver() noexcept(is_noexcept_restore<nothrow_restore>::value) {
+    if (policy_.should_execute()) {
+      invoke_restore([this]() { restore(); });
+    }
+  }
+};
+
+template <typename U, typename P, typename T>
+class shared_ptr_saver<U, P, std::shared_ptr<T>> : public basic_shared_ptr_saver<U, P, std::shared_ptr<T>, shared_ptr_slot<T>> {
+ public:
+  using basic_shared_ptr_saver<U, P, std::shared_ptr<T>, shared_ptr_slot<T>>::basic_shared_ptr_saver;
+};
+
+template <typename U, typename P, typename T>
+class shared_ptr_saver<U, P, rcu_slot<T>> : public basic_shared_ptr_saver<U, P, rcu_slot<T>, rcu_shared_ptr_slot<T>> {
+ public:
+  using basic_shared_ptr_saver<U, P, rcu_slot<T>, rcu_shared_ptr_slot<T>>::basic_shared_ptr_saver;
+};
+
+#if defined(__cpp_lib_atomic_shared_ptr) && __cpp_lib_atomic_shared_ptr >= 201711L
+template <typename U, typename P, typename T>
+class shared_ptr_saver<U, P, std::atomic<std::shared_ptr<T>>> : public basic_shared_ptr_saver<U, P, std::atomic<std::shared_ptr<T>>, atomic_shared_ptr_slot<T>> {
+ public:
+  using basic_shared_ptr_saver<U, P, std::atomic<std::shared_ptr<T>>, atomic_shared_ptr_slot<T>>::basic_shared_ptr_saver;
+};
+#endif
+
+// Locks mutex in shared mode if it supports lock_shared(), otherwise exclusively.
+template <typename M, typename = void>
+class shared_lock_guard {
+  M& mutex_;
+
+ public:
+  explicit shared_lock_guard(M& mutex) : mutex_{mutex} {
+    mutex_.lock();
+  }
+
+  shared_lock_guard(const shared_lock_guard&) = delete;
+  shared_lock_guard& operator=(const shared_lock_guard&) = delete;
+
+  ~shared_lock_guard() {
+    mutex_.unlock();
+  }
+};
+
+template <typename M>
+class shared_lock_guard<M, typename make_void<decltype(std::declval<M&>().lock_shared())>::type> {
+  M& mutex_;
+
+ public:
+  explicit shared_lock_guard(M& mutex) : mutex_{mutex} {
+    mutex_.lock_shared();
+  }
+
+  shared_lock_guard(const shared_lock_guard&) = delete;
+  shared_lock_guard& operator=(const shared_lock_guard&) = delete;
+
+  ~shared_lock_guard() {
+    mutex_.unlock_shared();
+  }
+};
+
+template <typename U, typename M, typename P>
+class locked_saver {
+  using T = typename std::remove_reference<U>::type;
+
+  static_assert(!std::is_const<T>::value,
+                "locked_saver requires not const type.");
+  static_assert(!std::is_rvalue_reference<U>::value && (std::is_lvalue_reference<U>::value || std::is_same<T, U>::value),
+                "locked_saver requires lvalue type.");
+  static_assert(!std::is_array<T>::value,
+                "locked_saver requires not array type.");
+  static_assert(std::is_constructible<T, T&>::value,
+                "locked_saver requires copy constructible.");
+  static_assert(std::is_move_constructible<T>::value && std::is_move_assignable<T>::value,
+                "locked_saver requires swappable type.");
+  static_assert(is_policy<P>::value,
+                "locked_saver requires policy with explicit P(bool) noexcept, dismiss() noexcept and should_execute() const noexcept.");
+#if defined(STATE_SAVER_NO_THROW_RESTORE)
+  static_assert(std::is_nothrow_move_constructible<T>::value && std::is_nothrow_move_assignable<T>::value,
+                "locked_saver requires noexcept swap.");
+#endif
+
+  static T snapshot(T& object, M& mutex) {
+    shared_lock_guard<M> lock{mutex};
+    return T(object);
+  }
+
+  void swap_locked(T& value) {
+    std::lock_guard<M> lock{mutex_};
+    using std::swap;
+    swap(previous_ref_, value);
+  }
+
+  P policy_;
+  T& previous_ref_;
+  M& mutex_;
+  T previous_value_;
+
+ public:
+  locked_saver() = delete;
+  locked_saver(const locked_saver&) = delete;
+  locked_saver(locked_saver&&) = delete;
+  locked_saver& operator=(const locked_saver&) = delete;
+  locked_saver& operator=(locked_saver&&) = delete;
+
+  locked_saver(T&&, M&) = delete;
+  locked_saver(const T&, M&) = delete;
+
+  // Copies the object under shared lock if the mutex supports it, otherwise under exclusive lock.
+  locked_saver(T& object, M& mutex)
+      : policy_{true},
+        previous_ref_{object},
+        mutex_{mutex},
+        previous_value_{snapshot(object, mutex)} {}
+
+  void dismiss() noexcept {
+    policy_.dismiss();
+  }
+
+  // The copy is made outside the lock, only swap is done under exclusive lock.
+  void restore() noexcept(is_noexcept_restore<false>::value) {
+    invoke_restore([this]() {
+      T value{previous_value_};
+      swap_locked(value);
+    });
+  }
+
+  // Only swap is done under exclusive lock, the overridden value is destroyed after unlock.
+  ~locked_saver() noexcept(is_noexcept_restore<false>::value) {
+    if (policy_.should_execute()) {
+      invoke_restore([this]() { swap_locked(previous_value_); });
+    }
+  }
+};
+
+} // namespace state_saver::detail
+
+// saver_exit_seqlock saves the original value of the seqlocked object and restores on scope exit.
+template <typename U>
+class saver_exit_seqlock : public detail::seqlock_saver<U, detail::on_exit_policy> {
+ public:
+  using detail::seqlock_saver<U, detail::on_exit_policy>::seqlock_saver;
+};
+
+// saver_fail_seqlock saves the original value of the seqlocked object and restores on scope exit when an exception has been thrown.
+template <typename U>
+class saver_fail_seqlock : public detail::seqlock_saver<U, detail::on_fail_policy> {
+ public:
+  using detail::seqlock_saver<U, detail::on_fail_policy>::seqlock_saver;
+};
+
+// saver_success_seqlock saves the original value of the seqlocked object and restores on scope exit when no exceptions have been thrown.
+template <typename U>
+class saver_success_seqlock : public detail::seqlock_saver<U, detail::on_success_policy> {
+ public:
+  using detail::seqlock_saver<U, detail::on_success_policy>::seqlock_saver;
+};
+
+// saver_exit_shared_ptr saves the pointer published in the shared_ptr slot and publishes it back on scope exit.
+template <typename U>
+class saver_exit_shared_ptr : public detail::shared_ptr_saver<U, detail::on_exit_policy> {
+ public:
+  using detail::shared_ptr_saver<U, detail::on_exit_policy>::shared_ptr_saver;
+};
+
+// saver_fail_shared_ptr saves the pointer published in the shared_ptr slot and publishes it back on scope exit when an exception has been thrown.
+template <typename U>
+class saver_fail_shared_ptr : public detail::shared_ptr_saver<U, detail::on_fail_policy> {
+ public:
+  using detail::shared_ptr_saver<U, detail::on_fail_policy>::shared_ptr_saver;
+};
+
+// saver_success_shared_ptr saves the pointer published in the shared_ptr slot and publishes it back on scope exit when no exceptions have been thrown.
+template <typename U>
+class saver_success_shared_ptr : public detail::shared_ptr_saver<U, detail::on_success_policy> {
+ public:
+  using detail::shared_ptr_saver<U, detail::on_success_policy>::shared_ptr_saver;
+};
+
+// saver_exit_locked saves the original value of the object guarded by mutex and restores on scope exit.
+template <typename U, typename M>
+class saver_exit_locked : public detail::locked_saver<U, M, detail::on_exit_policy> {
+ public:
+  using detail::locked_saver<U, M, detail::on_exit_policy>::locked_saver;
+};
+
+// saver_fail_locked saves the original value of the object guarded by mutex and restores on scope exit when an exception has been thrown.
+template <typename U, typename M>
+class saver_fail_locked : public detail::locked_saver<U, M, detail::on_fail_policy> {
+ public:
+  using detail::locked_saver<U, M, detail::on_fail_policy>::locked_saver;
+};
+
+// saver_success_locked saves the original value of the object guarded by mutex and restores on scope exit when no exceptions have been thrown.
+template <typename U, typename M>
+class saver_success_locked : public detail::locked_saver<U, M, detail::on_success_policy> {
+ public:
+  using detail::locked_saver<U, M, detail::on_success_policy>::locked_saver;
+};
+
+#if defined(__cpp_deduction_guides) && __cpp_deduction_guides >= 201611L
+template <typename U, typename... Args>
+saver_exit_seqlock(U&, Args...) -> saver_exit_seqlock<U>;
+
+template <typename U, typename... Args>
+saver_fail_seqlock(U&, Args...) -> saver_fail_seqlock<U>;
+
+template <typename U, typename... Args>
+saver_success_seqlock(U&, Args...) -> saver_success_seqlock<U>;
+
+template <typename U, typename... Args>
+saver_exit_shared_ptr(U&, Args...) -> saver_exit_shared_ptr<U>;
+
+template <typename U, typename... Args>
+saver_fail_shared_ptr(U&, Args...) -> saver_fail_shared_ptr<U>;
+
+template <typename U, typename... Args>
+saver_success_shared_ptr(U&, Args...) -> saver_success_shared_ptr<U>;
+
+template <typename U, typename M>
+saver_exit_locked(U&, M&) -> saver_exit_locked<U, M>;
+
+template <typename U, typename M>
+saver_fail_locked(U&, M&) -> saver_fail_locked<U, M>;
+
+template <typename U, typename M>
+saver_success_locked(U&, M&) -> saver_success_locked<U, M>;
+#endif
+
+} // namespace state_saver
+
+#endif // NEARGYE_STATE_SAVER_SYNC_HPP
@@ -0,0 +1,117 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch.hpp>
+
+#include <state_saver_arena.hpp>
+
+struct arena_test_big {
+  std::array<int, 1024> values;
+  std::string name;
+};
+
+static void arena_test_recurse(arena_test_big& big, int depth) {
+  saver_exit<arena_test_big, arena_storage> saver{big};
+  big.values[static_cast<std::size_t>(depth)] = -1;
+  big.name = std::to_string(depth);
+  if (depth < 200) {
+    arena_test_recurse(big, depth + 1);
+  }
+  REQUIRE(big.values[static_cast<std::size_t>(depth) + 1] == depth + 1);
+}
+
+TEST_CASE("arena_storage: snapshots restored in recursion") {
+  static_assert(sizeof(saver_exit<arena_test_big, arena_storage>) <= 4 * sizeof(void*), "");
+
+  arena_test_big big;
+  for (std::size_t i = 0; i < big.values.size(); ++i) {
+    big.values[i] = static_cast<int>(i);
+  }
+  big.name = "big";
+
+  const std::size_t used = state_saver::detail::snapshot_arena::local().used();
+  arena_test_recurse(big, 0);
+  REQUIRE(big.values[0] == 0);
+  REQUIRE(big.name == "big");
+  REQUIRE(state_saver::detail::snapshot_arena::local().used() == used);
+
+  REQUIRE_THROWS([&big]() {
+    saver_fail<arena_test_big, arena_storage> saver{big};
+    big.name = "changed";
+    throw std::runtime_error{"error"};
+  }());
+  REQUIRE(big.name == "big");
+}
+
+TEST_CASE("arena_storage: LIFO and out of order free") {
+  state_saver::detail::snapshot_arena arena;
+  void* a = arena.allocate(100);
+  void* b = arena.allocate(200);
+  arena.deallocate(b);
+  REQUIRE(arena.allocate(200) == b);
+
+  void* c = arena.allocate(300);
+  const std::size_t used = arena.used();
+  arena.deallocate(b); // Not on the top, only marked.
+  REQUIRE(arena.used() == used);
+  arena.deallocate(c);
+  REQUIRE(arena.allocate(10) == b);
+
+  std::vector<void*> blocks;
+  for (int i = 0; i < 100; ++i) {
+    blocks.push_back(arena.allocate(4096)); // Grows into new chunks.
+  }
+  void* huge = arena.allocate(std::size_t{4} << 20);
+  arena.deallocate(huge);
+  for (auto it = blocks.rbegin(); it != blocks.rend(); ++it) {
+    arena.deallocate(*it);
+  }
+  arena.deallocate(a);
+}
+
+TEST_CASE("arena_storage: arena per thread") {
+  std::vector<std::thread> threads;
+  std::atomic<int> errors{0};
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&errors]() {
+      arena_test_big big;
+      big.values.fill(1);
+      for (int i = 0; i < 1000; ++i) {
+        saver_exit<arena_test_big, arena_storage> saver{big};
+        big.values.fill(2);
+      }
+      if (big.values[0] != 1) {
+        ++errors;
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  REQUIRE(errors == 0);
+}
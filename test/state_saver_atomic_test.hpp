@@ -0,0 +1,97 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <stdexcept>
+
+#include <catch.hpp>
+
+#include <state_saver.hpp>
+
+TEST_CASE("saver_exit_atomic: called on scope leave") {
+  std::atomic<int> counter{1};
+  {
+    saver_exit_atomic<decltype(counter)> saver{counter};
+    counter.store(-1);
+  }
+
+  REQUIRE(counter.load() == 1);
+}
+
+TEST_CASE("saver_exit_atomic: called on error") {
+  std::atomic<int> counter{1};
+  REQUIRE_THROWS([&]() {
+    saver_exit_atomic<decltype(counter)> saver{counter, std::memory_order_acq_rel};
+    counter.store(-1);
+    throw std::runtime_error{"error"};
+  }());
+
+  REQUIRE(counter.load() == 1);
+}
+
+TEST_CASE("saver_exit_atomic: conditional restore") {
+  std::atomic<int> counter{1};
+  {
+    saver_exit_atomic<decltype(counter)> saver{counter, -1};
+    REQUIRE(counter.load() == -1);
+  }
+  REQUIRE(counter.load() == 1);
+
+  {
+    saver_exit_atomic<decltype(counter)> saver{counter, -1, std::memory_order_acq_rel};
+    counter.store(2); // Concurrent writer changed the value, restore must not stomp on it.
+  }
+  REQUIRE(counter.load() == 2);
+}
+
+TEST_CASE("saver_exit_atomic: dismiss and restore") {
+  std::atomic<bool> flag{false};
+  {
+    saver_exit_atomic<decltype(flag)> saver{flag, true};
+    REQUIRE(saver.restore());
+    REQUIRE_FALSE(flag.load());
+    REQUIRE_FALSE(saver.restore());
+    flag.store(true);
+    saver.dismiss();
+  }
+
+  REQUIRE(flag.load());
+}
+
+TEST_CASE("saver_fail_atomic and saver_success_atomic") {
+  std::atomic<int> counter{1};
+  {
+    saver_fail_atomic<decltype(counter)> saver{counter, 2};
+  }
+  REQUIRE(counter.load() == 2);
+
+  {
+    saver_success_atomic<decltype(counter)> saver{counter, 3};
+  }
+  REQUIRE(counter.load() == 2);
+
+  REQUIRE_THROWS([&]() {
+    saver_fail_atomic<decltype(counter)> saver{counter, 4};
+    throw std::runtime_error{"error"};
+  }());
+  REQUIRE(counter.load() == 2);
+}
@@ -0,0 +1,114 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <catch.hpp>
+
+#include <state_saver.hpp>
+
+TEST_CASE("saver_exit_bits: restores only masked bits") {
+  std::uint64_t flags = 0x0F;
+  {
+    saver_exit_bits<decltype(flags)> saver{flags, 0x03};
+    flags &= ~std::uint64_t{0x01};
+    flags |= 0x30; // Change of other bits during scope.
+    REQUIRE(flags == 0x3E);
+  }
+
+  REQUIRE(flags == 0x3F);
+}
+
+TEST_CASE("saver_exit_bits: called on error") {
+  std::uint64_t flags = 0x01;
+  REQUIRE_THROWS([&]() {
+    saver_exit_bits<decltype(flags)> saver{flags, 0x03};
+    flags = 0x02;
+    throw std::runtime_error{"error"};
+  }());
+
+  REQUIRE(flags == 0x01);
+}
+
+TEST_CASE("saver_exit_bits: dismiss and restore") {
+  std::uint8_t flags = 0x01;
+  {
+    saver_exit_bits<decltype(flags)> saver{flags, 0x01};
+    flags = 0x80;
+    saver.restore();
+    REQUIRE(flags == 0x81);
+    flags = 0x00;
+    saver.dismiss();
+  }
+
+  REQUIRE(flags == 0x00);
+}
+
+TEST_CASE("saver_fail_bits and saver_success_bits") {
+  unsigned flags = 0x01;
+  {
+    saver_fail_bits<decltype(flags)> saver_fail{flags, 0x01};
+    saver_success_bits<decltype(flags)> saver_success{flags, 0x02};
+    flags = 0x02;
+  }
+  REQUIRE(flags == 0x00);
+}
+
+TEST_CASE("saver_exit_bits: atomic restores only masked bits") {
+  std::atomic<std::uint64_t> flags{0x0F};
+  {
+    saver_exit_bits<decltype(flags)> saver{flags, 0x03, std::memory_order_acq_rel};
+    flags.fetch_and(~std::uint64_t{0x03});
+    flags.fetch_or(0x30);
+    REQUIRE(flags.load() == 0x3C);
+  }
+
+  REQUIRE(flags.load() == 0x3F);
+}
+
+TEST_CASE("saver_exit_bits: atomic concurrent overrides of different bits") {
+  std::atomic<std::uint64_t> flags{0};
+  std::atomic<int> errors{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&flags, &errors, t]() {
+      const std::uint64_t bit = std::uint64_t{1} << t;
+      for (int i = 0; i < 1000; ++i) {
+        saver_exit_bits<decltype(flags)> saver{flags, bit};
+        flags.fetch_or(bit);
+        if ((flags.load() & bit) == 0) {
+          ++errors;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  REQUIRE(errors.load() == 0);
+  REQUIRE(flags.load() == 0);
+}
@@ -0,0 +1,114 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <array>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <catch.hpp>
+
+#include <state_saver_compress.hpp>
+
+struct compress_test_table {
+  std::uint32_t header;
+  std::array<std::uint16_t, 4096> cells;
+};
+
+static bool compress_test_round_trip(const std::vector<unsigned char>& data) {
+  std::vector<unsigned char> compressed;
+  if (!state_saver::detail::compress(data.data(), data.size(), compressed)) {
+    return true; // Incompressible data is kept as is.
+  }
+  std::vector<unsigned char> result(data.size());
+  return state_saver::detail::decompress(compressed.data(), compressed.size(), result.data(), result.size()) && result == data;
+}
+
+TEST_CASE("compressed_storage: codec round trip") {
+  std::vector<unsigned char> zeros(100000, 0);
+  std::vector<unsigned char> compressed;
+  REQUIRE(state_saver::detail::compress(zeros.data(), zeros.size(), compressed));
+  REQUIRE(compressed.size() * 30 < zeros.size());
+  REQUIRE(compress_test_round_trip(zeros));
+
+  std::vector<unsigned char> pattern;
+  for (int i = 0; i < 20000; ++i) {
+    pattern.push_back(static_cast<unsigned char>(i % 7 + i % 3));
+  }
+  REQUIRE(state_saver::detail::compress(pattern.data(), pattern.size(), compressed));
+  REQUIRE(compressed.size() * 4 < pattern.size());
+  REQUIRE(compress_test_round_trip(pattern));
+
+  std::mt19937 gen{42};
+  std::vector<unsigned char> noise(10000);
+  for (auto& b : noise) {
+    b = static_cast<unsigned char>(gen());
+  }
+  REQUIRE_FALSE(state_saver::detail::compress(noise.data(), noise.size(), compressed));
+
+  std::vector<unsigned char> mixed(noise);
+  mixed.insert(mixed.end(), pattern.begin(), pattern.end());
+  mixed.insert(mixed.end(), noise.begin(), noise.begin() + 5000);
+  REQUIRE(compress_test_round_trip(mixed));
+
+  for (std::size_t size = 0; size < 20; ++size) {
+    REQUIRE(compress_test_round_trip(std::vector<unsigned char>(pattern.begin(), pattern.begin() + static_cast<std::ptrdiff_t>(size))));
+  }
+
+  unsigned char out[4];
+  const unsigned char malformed[] = {0xC0, 0x01, 0x00};
+  REQUIRE_FALSE(state_saver::detail::decompress(malformed, sizeof(malformed), out, sizeof(out)));
+}
+
+TEST_CASE("compressed_storage: snapshot restored on scope leave") {
+  static_assert(std::is_same<compressed_storage::snapshot<int>, inline_storage::snapshot<int>>::value, "");
+  static_assert(is_saver_storage<compressed_storage, compress_test_table>::value, "");
+
+  compress_test_table table;
+  table.header = 7;
+  table.cells.fill(1);
+  table.cells[100] = 2;
+
+  {
+    saver_exit<compress_test_table, compressed_storage> saver{table};
+    table.header = 0;
+    table.cells.fill(0);
+  }
+  REQUIRE(table.header == 7);
+  REQUIRE(table.cells[0] == 1);
+  REQUIRE(table.cells[100] == 2);
+
+  REQUIRE_THROWS([&table]() {
+    saver_fail<compress_test_table, compressed_storage> saver{table};
+    table.cells[100] = 3;
+    throw std::runtime_error{"error"};
+  }());
+  REQUIRE(table.cells[100] == 2);
+
+  {
+    saver_success<compress_test_table, compressed_storage> saver{table};
+    table.cells[100] = 3;
+    saver.dismiss();
+  }
+  REQUIRE(table.cells[100] == 3);
+}
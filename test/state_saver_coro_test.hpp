@@ -0,0 +1,186 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <exception>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+
+#include <catch.hpp>
+
+#include <state_saver_coro.hpp>
+
+#if defined(NEARGYE_STATE_SAVER_CORO)
+
+struct coro_task {
+  struct promise_type {
+    std::exception_ptr exception;
+
+    coro_task get_return_object() {
+      return coro_task{std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+
+    std::suspend_never initial_suspend() noexcept {
+      return {};
+    }
+
+    std::suspend_always final_suspend() noexcept {
+      return {};
+    }
+
+    void return_void() noexcept {}
+
+    void unhandled_exception() noexcept {
+      exception = std::current_exception();
+    }
+  };
+
+  std::coroutine_handle<promise_type> handle;
+
+  explicit coro_task(std::coroutine_handle<promise_type> h) : handle{h} {}
+  coro_task(coro_task&& other) noexcept : handle{std::exchange(other.handle, {})} {}
+  coro_task& operator=(coro_task&& other) noexcept {
+    std::swap(handle, other.handle);
+    return *this;
+  }
+
+  ~coro_task() {
+    if (handle) {
+      handle.destroy();
+    }
+  }
+};
+
+struct coro_resume_later {
+  std::coroutine_handle<>* slot;
+
+  bool await_ready() const noexcept {
+    return false;
+  }
+
+  void await_suspend(std::coroutine_handle<> handle) const noexcept {
+    *slot = handle;
+  }
+
+  void await_resume() const noexcept {}
+};
+
+struct coro_on_unwinding {
+  std::function<void()> f;
+
+  ~coro_on_unwinding() {
+    f();
+  }
+};
+
+TEST_CASE("saver_exit_coro: scoped override is undone around suspension") {
+  int value = 1;
+  int inside = 0;
+  std::coroutine_handle<> slot;
+  auto task = [](int& value, int& inside, std::coroutine_handle<>* slot) -> coro_task {
+    saver_exit_coro<int&> saver{value, coro_scoped};
+    value = 2;
+    co_await saver.around(coro_resume_later{slot});
+    inside = value;
+  }(value, inside, &slot);
+
+  REQUIRE(value == 1);
+  slot.resume();
+  REQUIRE(inside == 2);
+  REQUIRE(value == 1);
+  REQUIRE(task.handle.done());
+}
+
+TEST_CASE("saver_exit_coro: not scoped override is kept around suspension") {
+  int value = 1;
+  std::coroutine_handle<> slot;
+  auto task = [](int& value, std::coroutine_handle<>* slot) -> coro_task {
+    saver_exit_coro<int&> saver{value};
+    value = 2;
+    co_await saver.around(coro_resume_later{slot});
+  }(value, &slot);
+
+  REQUIRE(value == 2);
+  slot.resume();
+  REQUIRE(value == 1);
+}
+
+TEST_CASE("saver_fail_coro: resumed on other thread and exception context") {
+  int value = 1;
+  std::coroutine_handle<> slot;
+  coro_task task{nullptr};
+
+  // Coroutine starts while an exception is in flight, so uncaught exceptions count at construction is 1.
+  try {
+    coro_on_unwinding start{[&]() {
+      task = [](int& value, std::coroutine_handle<>* slot) -> coro_task {
+        saver_fail_coro<int&> saver{value};
+        value = 2;
+        co_await saver.around(coro_resume_later{slot});
+        throw std::runtime_error{"error"};
+      }(value, &slot);
+    }};
+    throw std::runtime_error{"error"};
+  } catch (...) {
+  }
+  REQUIRE(value == 2);
+
+  std::thread thread{[&slot]() {
+    slot.resume();
+  }};
+  thread.join();
+
+  REQUIRE(task.handle.promise().exception != nullptr);
+  REQUIRE(value == 1);
+}
+
+TEST_CASE("saver_success_coro: restored only on completion") {
+  int value = 1;
+  std::coroutine_handle<> slot;
+  auto task = [](int& value, std::coroutine_handle<>* slot) -> coro_task {
+    saver_success_coro<int&> saver{value};
+    value = 2;
+    co_await saver.around(coro_resume_later{slot});
+  }(value, &slot);
+
+  std::thread thread{[&slot]() {
+    slot.resume();
+  }};
+  thread.join();
+  REQUIRE(value == 1);
+}
+
+TEST_CASE("saver_fail_coro: destroyed while suspended") {
+  int value = 1;
+  std::coroutine_handle<> slot;
+  {
+    auto task = [](int& value, std::coroutine_handle<>* slot) -> coro_task {
+      saver_fail_coro<int&> saver{value};
+      value = 2;
+      co_await saver.around(coro_resume_later{slot});
+    }(value, &slot);
+    REQUIRE(value == 2);
+  }
+  REQUIRE(value == 1);
+}
+
+#endif
@@ -0,0 +1,144 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <catch.hpp>
+
+#include <state_saver.hpp>
+
+#if defined(__cpp_structured_bindings) && __cpp_structured_bindings >= 201606L && defined(__cpp_lib_is_aggregate) && __cpp_lib_is_aggregate >= 201703L
+
+struct diff_counted {
+  int value = 0;
+  int* assignments = nullptr;
+
+  diff_counted() = default;
+  diff_counted(const diff_counted&) = default;
+  diff_counted& operator=(const diff_counted& other) {
+    value = other.value;
+    ++*assignments;
+    return *this;
+  }
+
+  bool operator==(const diff_counted& other) const {
+    return value == other.value;
+  }
+};
+
+struct diff_not_comparable {
+  int value = 0;
+};
+
+struct diff_config {
+  int level = 1;
+  std::string name = "name";
+  std::vector<int> values = {1, 2, 3};
+  diff_counted counted;
+  diff_not_comparable not_comparable;
+};
+
+static_assert(state_saver::detail::fields_count<diff_config>::value == 5, "");
+
+TEST_CASE("saver_exit_diff: called on scope leave") {
+  diff_config config;
+  {
+    saver_exit_diff<decltype(config)> saver{config};
+    config.level = -1;
+    config.name = "other";
+    config.not_comparable.value = -1;
+  }
+
+  REQUIRE(config.level == 1);
+  REQUIRE(config.name == "name");
+  REQUIRE(config.values == std::vector<int>{1, 2, 3});
+  REQUIRE(config.not_comparable.value == 0);
+}
+
+TEST_CASE("saver_exit_diff: unchanged fields are not assigned") {
+  int assignments = 0;
+  diff_config config;
+  config.counted.assignments = &assignments;
+  {
+    saver_exit_diff<decltype(config)> saver{config};
+    config.level = -1;
+  }
+  REQUIRE(config.level == 1);
+  REQUIRE(assignments == 0);
+
+  {
+    saver_exit_diff<decltype(config)> saver{config};
+    config.counted.value = -1;
+  }
+  REQUIRE(config.counted.value == 0);
+  REQUIRE(assignments == 1);
+}
+
+TEST_CASE("saver_exit_diff: dismiss and restore") {
+  diff_config config;
+  {
+    saver_exit_diff<decltype(config)> saver{config};
+    config.name = "other";
+    saver.restore();
+    REQUIRE(config.name == "name");
+    config.level = -1;
+    saver.dismiss();
+  }
+
+  REQUIRE(config.level == -1);
+}
+
+TEST_CASE("saver_fail_diff: called only on error") {
+  diff_config config;
+  {
+    saver_fail_diff<decltype(config)> saver{config};
+    config.level = -1;
+  }
+  REQUIRE(config.level == -1);
+
+  REQUIRE_THROWS([&]() {
+    saver_fail_diff<decltype(config)> saver{config};
+    config.level = 1;
+    throw std::runtime_error{"error"};
+  }());
+  REQUIRE(config.level == -1);
+}
+
+TEST_CASE("saver_success_diff: called only on success") {
+  diff_config config;
+  {
+    saver_success_diff<decltype(config)> saver{config};
+    config.level = -1;
+  }
+  REQUIRE(config.level == 1);
+
+  REQUIRE_THROWS([&]() {
+    saver_success_diff<decltype(config)> saver{config};
+    config.level = -1;
+    throw std::runtime_error{"error"};
+  }());
+  REQUIRE(config.level == -1);
+}
+
+#endif
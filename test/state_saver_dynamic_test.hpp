@@ -0,0 +1,160 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <catch.hpp>
+
+#include <state_saver_dynamic.hpp>
+
+dynamic_var<int> dynamic_log_level{1};
+
+TEST_CASE("saver_dynamic: override until scope leave") {
+  REQUIRE(dynamic_log_level.get() == 1);
+  {
+    saver_dynamic<int> saver{dynamic_log_level, 2};
+    REQUIRE(dynamic_log_level.get() == 2);
+    {
+      SAVER_DYNAMIC(dynamic_log_level, 3);
+      REQUIRE(dynamic_log_level.get() == 3);
+    }
+    REQUIRE(dynamic_log_level.get() == 2);
+    saver.value() = 4;
+    REQUIRE(dynamic_log_level.get() == 4);
+  }
+  REQUIRE(dynamic_log_level.get() == 1);
+}
+
+TEST_CASE("saver_dynamic: override until error") {
+  REQUIRE_THROWS([]() {
+    SAVER_DYNAMIC(dynamic_log_level, 2);
+    REQUIRE(dynamic_log_level.get() == 2);
+    throw std::runtime_error{"error"};
+  }());
+  REQUIRE(dynamic_log_level.get() == 1);
+
+  WITH_SAVER_DYNAMIC(dynamic_log_level, 2) {
+    REQUIRE(dynamic_log_level.get() == 2);
+  }
+  REQUIRE(dynamic_log_level.get() == 1);
+}
+
+TEST_CASE("saver_dynamic: different variables") {
+  dynamic_var<std::string> name{"name"};
+  {
+    SAVER_DYNAMIC(name, "other");
+    SAVER_DYNAMIC(dynamic_log_level, 2);
+    REQUIRE(name.get() == "other");
+    REQUIRE(dynamic_log_level.get() == 2);
+  }
+  REQUIRE(name.get() == "name");
+}
+
+static int dynamic_test_nested(dynamic_var<int> (&vars)[64], int depth) {
+  if (depth == 64) {
+    return dynamic_log_level.get();
+  }
+  SAVER_DYNAMIC(vars[depth], depth);
+  if (vars[depth].get() != depth) {
+    return -1;
+  }
+  return dynamic_test_nested(vars, depth + 1);
+}
+
+TEST_CASE("saver_dynamic: lookup is not affected by overrides of other variables") {
+  dynamic_var<int> vars[64];
+  SAVER_DYNAMIC(dynamic_log_level, 2);
+  REQUIRE(dynamic_test_nested(vars, 0) == 2);
+  REQUIRE(vars[63].get() == 0);
+  REQUIRE(dynamic_log_level.get() == 2);
+}
+
+TEST_CASE("saver_dynamic: override is not visible to other threads") {
+  SAVER_DYNAMIC(dynamic_log_level, 2);
+  std::atomic<int> other{0};
+  std::thread thread{[&other]() {
+    other = dynamic_log_level.get();
+  }};
+  thread.join();
+
+  REQUIRE(dynamic_log_level.get() == 2);
+  REQUIRE(other.load() == 1);
+}
+
+TEST_CASE("saver_dynamic_context: empty context") {
+  const dynamic_context context = capture_dynamic_context();
+  REQUIRE(context.empty());
+  saver_dynamic_context saver{context};
+  REQUIRE(dynamic_log_level.get() == 1);
+}
+
+TEST_CASE("saver_dynamic_context: propagate overrides to other thread") {
+  dynamic_var<std::string> name{"name"};
+  dynamic_context context;
+  {
+    SAVER_DYNAMIC(dynamic_log_level, 2);
+    SAVER_DYNAMIC(name, "other");
+    SAVER_DYNAMIC(dynamic_log_level, 3);
+    context = capture_dynamic_context();
+  }
+  REQUIRE(context.size() == 2);
+  REQUIRE(dynamic_log_level.get() == 1);
+
+  std::atomic<int> level{0};
+  std::atomic<int> level_after{0};
+  std::atomic<bool> name_ok{false};
+  std::atomic<std::size_t> nested_size{0};
+  std::thread thread{[&]() {
+    {
+      saver_dynamic_context saver{context};
+      level = dynamic_log_level.get();
+      name_ok = name.get() == "other";
+      nested_size = capture_dynamic_context().size();
+    }
+    level_after = dynamic_log_level.get();
+  }};
+  thread.join();
+
+  REQUIRE(level.load() == 3);
+  REQUIRE(name_ok.load());
+  REQUIRE(nested_size.load() == 2);
+  REQUIRE(level_after.load() == 1);
+}
+
+TEST_CASE("saver_dynamic_context: local overrides shadow applied context") {
+  dynamic_context context;
+  {
+    SAVER_DYNAMIC(dynamic_log_level, 2);
+    context = capture_dynamic_context();
+  }
+
+  saver_dynamic_context saver{context};
+  REQUIRE(dynamic_log_level.get() == 2);
+  {
+    SAVER_DYNAMIC(dynamic_log_level, 3);
+    REQUIRE(dynamic_log_level.get() == 3);
+  }
+  REQUIRE(dynamic_log_level.get() == 2);
+}
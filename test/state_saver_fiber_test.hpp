@@ -0,0 +1,191 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <stdexcept>
+#include <string>
+
+#include <catch.hpp>
+
+#include <state_saver_fiber.hpp>
+
+#if defined(__linux__)
+#include <ucontext.h>
+#endif
+
+thread_local int fiber_value = 0;
+
+TEST_CASE("saver_exit_fiber: overrides are swapped on context switch") {
+  fiber_state& thread_state = fiber_state::current();
+  fiber_state a;
+  fiber_state b;
+
+  fiber_switch(a);
+  {
+    SAVER_EXIT_FIBER(fiber_value);
+    fiber_value = 1;
+    {
+      saver_exit_fiber<decltype(fiber_value)> saver{fiber_value};
+      fiber_value = 2;
+
+      fiber_switch(b);
+      REQUIRE(fiber_value == 0);
+      fiber_value = 3; // Change without saver in fiber b.
+
+      fiber_switch(a);
+      REQUIRE(fiber_value == 2);
+    }
+    REQUIRE(fiber_value == 1);
+
+    fiber_switch(thread_state);
+    REQUIRE(fiber_value == 3);
+
+    fiber_switch(a);
+    REQUIRE(fiber_value == 1);
+  }
+  REQUIRE(fiber_value == 3);
+  REQUIRE(a.empty());
+
+  fiber_switch(thread_state);
+  fiber_value = 0;
+}
+
+TEST_CASE("saver_exit_fiber: dynamic_var overrides are fiber-local") {
+  dynamic_var<std::string> name{"name"};
+  fiber_state& thread_state = fiber_state::current();
+  fiber_state a;
+
+  fiber_switch(a);
+  {
+    SAVER_DYNAMIC(name, "fiber");
+    REQUIRE(name.get() == "fiber");
+
+    fiber_switch(thread_state);
+    REQUIRE(name.get() == "name");
+
+    fiber_switch(a);
+    REQUIRE(name.get() == "fiber");
+  }
+  REQUIRE(name.get() == "name");
+
+  fiber_switch(thread_state);
+}
+
+TEST_CASE("saver_exit_fiber: running fiber with dynamic_var override is not empty") {
+  dynamic_var<int> depth{0};
+  fiber_state& thread_state = fiber_state::current();
+  fiber_state a;
+
+  fiber_switch(a);
+  REQUIRE(a.empty());
+  {
+    SAVER_DYNAMIC(depth, 1);
+    REQUIRE_FALSE(a.empty());
+  }
+  REQUIRE(a.empty());
+
+  fiber_switch(thread_state);
+}
+
+TEST_CASE("saver_exit_fiber: macros") {
+  WITH_SAVER_EXIT_FIBER(fiber_value) {
+    fiber_value = 1;
+  }
+  REQUIRE(fiber_value == 0);
+
+  REQUIRE_THROWS([]() {
+    SAVER_FAIL_FIBER(fiber_value);
+    MAKE_SAVER_SUCCESS_FIBER(saver, fiber_value);
+    fiber_value = 1;
+    throw std::runtime_error{"error"};
+  }());
+  REQUIRE(fiber_value == 0);
+
+  WITH_SAVER_SUCCESS_FIBER(fiber_value) {
+    fiber_value = 1;
+  }
+  REQUIRE(fiber_value == 0);
+
+  WITH_SAVER_FAIL_FIBER(fiber_value) {
+    fiber_value = 1;
+  }
+  REQUIRE(fiber_value == 1);
+  fiber_value = 0;
+}
+
+TEST_CASE("saver_fail_fiber and saver_success_fiber") {
+  REQUIRE_THROWS([]() {
+    saver_fail_fiber<decltype(fiber_value)> saver_fail{fiber_value};
+    saver_success_fiber<decltype(fiber_value)> saver_success{fiber_value};
+    fiber_value = 1;
+    throw std::runtime_error{"error"};
+  }());
+  REQUIRE(fiber_value == 0);
+}
+
+#if defined(__linux__)
+namespace fiber_test {
+
+ucontext_t main_context;
+ucontext_t fiber_context;
+fiber_state* main_state = nullptr;
+fiber_state fiber;
+int seen_in_fiber = -1;
+
+void fiber_main() {
+  SAVER_EXIT_FIBER(fiber_value);
+  fiber_value = 1;
+
+  // Yield to main.
+  fiber_switch(*main_state);
+  swapcontext(&fiber_context, &main_context);
+
+  seen_in_fiber = fiber_value;
+}
+
+} // namespace fiber_test
+
+TEST_CASE("saver_exit_fiber: ucontext fibers") {
+  using namespace fiber_test;
+  static char stack[64 * 1024];
+  main_state = &fiber_state::current();
+
+  getcontext(&fiber_context);
+  fiber_context.uc_stack.ss_sp = stack;
+  fiber_context.uc_stack.ss_size = sizeof(stack);
+  fiber_context.uc_link = &main_context;
+  makecontext(&fiber_context, fiber_main, 0);
+
+  fiber_switch(fiber);
+  swapcontext(&main_context, &fiber_context);
+  REQUIRE(fiber_value == 0);
+
+  fiber_value = 2;
+  fiber_switch(fiber);
+  swapcontext(&main_context, &fiber_context);
+  fiber_switch(*main_state);
+
+  REQUIRE(seen_in_fiber == 1);
+  REQUIRE(fiber_value == 2);
+  REQUIRE(fiber.empty());
+  fiber_value = 0;
+}
+#endif
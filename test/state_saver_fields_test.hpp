@@ -0,0 +1,115 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <stdexcept>
+#include <string>
+
+#include <catch.hpp>
+
+#include <state_saver.hpp>
+
+#if defined(__cpp_nontype_template_parameter_auto) && __cpp_nontype_template_parameter_auto >= 201606L
+
+struct request_context {
+  int timeout = 1;
+  int retries = 2;
+  std::string name = "name";
+  char payload[4096] = {};
+};
+
+static_assert(sizeof(saver_exit_fields<&request_context::timeout, &request_context::retries>) < sizeof(request_context), "");
+
+TEST_CASE("saver_exit_fields: called on scope leave") {
+  request_context ctx;
+  {
+    saver_exit_fields<&request_context::timeout, &request_context::name> saver{ctx};
+    ctx.timeout = -1;
+    ctx.retries = -2;
+    ctx.name = "other";
+  }
+
+  REQUIRE(ctx.timeout == 1);
+  REQUIRE(ctx.retries == -2);
+  REQUIRE(ctx.name == "name");
+}
+
+TEST_CASE("saver_exit_fields: called on error") {
+  request_context ctx;
+  REQUIRE_THROWS([&]() {
+    saver_exit_fields<&request_context::timeout, &request_context::retries> saver{ctx};
+    ctx.timeout = -1;
+    ctx.retries = -2;
+    throw std::runtime_error{"error"};
+  }());
+
+  REQUIRE(ctx.timeout == 1);
+  REQUIRE(ctx.retries == 2);
+}
+
+TEST_CASE("saver_exit_fields: dismiss and restore") {
+  request_context ctx;
+  {
+    saver_exit_fields<&request_context::timeout, &request_context::retries> saver{ctx};
+    ctx.timeout = -1;
+    saver.restore();
+    REQUIRE(ctx.timeout == 1);
+    ctx.retries = -2;
+    saver.dismiss();
+  }
+
+  REQUIRE(ctx.timeout == 1);
+  REQUIRE(ctx.retries == -2);
+}
+
+TEST_CASE("saver_fail_fields: called only on error") {
+  request_context ctx;
+  {
+    saver_fail_fields<&request_context::timeout> saver{ctx};
+    ctx.timeout = -1;
+  }
+  REQUIRE(ctx.timeout == -1);
+
+  REQUIRE_THROWS([&]() {
+    saver_fail_fields<&request_context::timeout> saver{ctx};
+    ctx.timeout = 1;
+    throw std::runtime_error{"error"};
+  }());
+  REQUIRE(ctx.timeout == -1);
+}
+
+TEST_CASE("saver_success_fields: called only on success") {
+  request_context ctx;
+  {
+    saver_success_fields<&request_context::timeout> saver{ctx};
+    ctx.timeout = -1;
+  }
+  REQUIRE(ctx.timeout == 1);
+
+  REQUIRE_THROWS([&]() {
+    saver_success_fields<&request_context::timeout> saver{ctx};
+    ctx.timeout = -1;
+    throw std::runtime_error{"error"};
+  }());
+  REQUIRE(ctx.timeout == -1);
+}
+
+#endif
@@ -0,0 +1,99 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+#include <catch.hpp>
+
+#include <state_saver_file.hpp>
+
+#if defined(__unix__) || defined(__APPLE__)
+
+static std::string file_test_read(int fd) {
+  std::string s(static_cast<std::size_t>(state_saver::detail::file_size(fd)), '\0');
+  REQUIRE(::pread(fd, &s[0], s.size(), 0) == static_cast<ssize_t>(s.size()));
+  return s;
+}
+
+static void file_test_write(int fd, const std::string& s, off_t offset) {
+  REQUIRE(::pwrite(fd, s.data(), s.size(), offset) == static_cast<ssize_t>(s.size()));
+}
+
+TEST_CASE("saver_exit_file_region: ranges restored on scope leave") {
+  std::FILE* file = std::tmpfile();
+  REQUIRE(file != nullptr);
+  const int fd = ::fileno(file);
+  file_test_write(fd, "hello world", 0);
+
+  {
+    saver_exit_file_region saver{fd, 0, 5};
+    file_test_write(fd, "HELLO", 0);
+    saver.save(4, 4); // Overlaps with already modified range.
+    file_test_write(fd, "0 WO", 4);
+    file_test_write(fd, "!!!", 11);
+    REQUIRE(file_test_read(fd) == "HELL0 WOrld!!!");
+  }
+  REQUIRE(file_test_read(fd) == "hello world");
+
+  REQUIRE_THROWS([fd]() {
+    saver_fail_file_region saver{fd, 6, 100};
+    file_test_write(fd, "there", 6);
+    throw std::runtime_error{"error"};
+  }());
+  REQUIRE(file_test_read(fd) == "hello world");
+
+  {
+    saver_success_file_region saver{fd, 6, 5};
+    file_test_write(fd, "there", 6);
+    saver.dismiss();
+  }
+  REQUIRE(file_test_read(fd) == "hello there");
+
+  std::fclose(file);
+}
+
+TEST_CASE("saver_exit_file_clone: whole file restored on scope leave") {
+  std::FILE* file = std::tmpfile();
+  REQUIRE(file != nullptr);
+  const int fd = ::fileno(file);
+  const std::string content(100000, 'a');
+  file_test_write(fd, content, 0);
+
+  {
+    saver_exit_file_clone saver{fd, "/tmp"};
+    file_test_write(fd, "bbbb", 50000);
+    REQUIRE(::ftruncate(fd, 60000) == 0);
+  }
+  REQUIRE(file_test_read(fd) == content);
+
+  {
+    saver_success_file_clone saver{fd, "/tmp"};
+    file_test_write(fd, "b", 200000);
+  }
+  REQUIRE(file_test_read(fd) == content);
+
+  std::fclose(file);
+}
+
+#endif
@@ -0,0 +1,105 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cfenv>
+#include <stdexcept>
+
+#include <catch.hpp>
+
+#include <state_saver_fpenv.hpp>
+
+#if defined(FE_DOWNWARD) && defined(FE_TONEAREST)
+TEST_CASE("saver_exit_fpenv: rounding mode restored on scope leave") {
+  const int round = std::fegetround();
+  {
+    saver_exit_fpenv saver;
+    std::fesetround(FE_DOWNWARD);
+    REQUIRE(std::fegetround() == FE_DOWNWARD);
+  }
+  REQUIRE(std::fegetround() == round);
+
+  REQUIRE_THROWS([]() {
+    saver_exit_fpenv saver;
+    std::fesetround(FE_DOWNWARD);
+    throw std::runtime_error{"error"};
+  }());
+  REQUIRE(std::fegetround() == round);
+}
+
+TEST_CASE("saver_fail_fpenv and saver_success_fpenv") {
+  const int round = std::fegetround();
+  {
+    saver_fail_fpenv saver_fail;
+    saver_success_fpenv saver_success;
+    std::fesetround(FE_DOWNWARD);
+  }
+  REQUIRE(std::fegetround() == round);
+
+  {
+    saver_fail_fpenv saver;
+    std::fesetround(FE_DOWNWARD);
+  }
+  REQUIRE(std::fegetround() == FE_DOWNWARD);
+  std::fesetround(round);
+}
+#endif
+
+#if defined(NEARGYE_STATE_SAVER_MXCSR)
+TEST_CASE("saver_exit_fpenv: FTZ/DAZ restored on scope leave") {
+  const unsigned int mxcsr = _mm_getcsr();
+  {
+    saver_exit_fpenv saver;
+    _mm_setcsr(mxcsr | 0x8040); // FTZ | DAZ.
+  }
+  REQUIRE(_mm_getcsr() == mxcsr);
+}
+
+TEST_CASE("saver_exit_mxcsr: FTZ/DAZ restored on scope leave") {
+  const unsigned int mxcsr = _mm_getcsr();
+  {
+    saver_exit_mxcsr saver;
+    _mm_setcsr(mxcsr | 0x8040); // FTZ | DAZ.
+  }
+  REQUIRE(_mm_getcsr() == mxcsr);
+
+  {
+    saver_exit_mxcsr saver;
+    _mm_setcsr(mxcsr | 0x8040);
+    saver.dismiss();
+  }
+  REQUIRE(_mm_getcsr() == (mxcsr | 0x8040));
+  _mm_setcsr(mxcsr);
+
+  REQUIRE_THROWS([mxcsr]() {
+    saver_fail_mxcsr saver;
+    _mm_setcsr(mxcsr | 0x8040);
+    throw std::runtime_error{"error"};
+  }());
+  REQUIRE(_mm_getcsr() == mxcsr);
+
+  {
+    saver_success_mxcsr saver;
+    _mm_setcsr(mxcsr | 0x8040);
+  }
+  REQUIRE(_mm_getcsr() == mxcsr);
+}
+#endif
@@ -0,0 +1,111 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <array>
+#include <string>
+
+#include <catch.hpp>
+
+#include <state_saver_history.hpp>
+
+struct history_test_grid {
+  std::array<int, 10000> cells;
+};
+
+TEST_CASE("history: undo and redo of trivially copyable object") {
+  history_test_grid grid;
+  grid.cells.fill(0);
+  history<history_test_grid> h{grid};
+  REQUIRE_FALSE(h.undo());
+  REQUIRE_FALSE(h.checkpoint());
+
+  grid.cells[10] = 1;
+  REQUIRE(h.checkpoint());
+  grid.cells[20] = 2;
+  grid.cells[9000] = 3;
+  REQUIRE(h.checkpoint());
+  REQUIRE(h.undo_count() == 2);
+  REQUIRE(h.memory_usage() < sizeof(history_test_grid) + 256);
+
+  grid.cells[5] = 100; // Not checkpointed, discarded by undo.
+  REQUIRE(h.undo());
+  REQUIRE(grid.cells[5] == 0);
+  REQUIRE(grid.cells[10] == 1);
+  REQUIRE(grid.cells[20] == 0);
+  REQUIRE(grid.cells[9000] == 0);
+  REQUIRE(h.undo());
+  REQUIRE(grid.cells[10] == 0);
+  REQUIRE_FALSE(h.undo());
+
+  REQUIRE(h.redo());
+  REQUIRE(h.redo());
+  REQUIRE(grid.cells[10] == 1);
+  REQUIRE(grid.cells[9000] == 3);
+  REQUIRE_FALSE(h.redo());
+
+  REQUIRE(h.undo());
+  grid.cells[30] = 4;
+  REQUIRE(h.checkpoint());
+  REQUIRE(h.redo_count() == 0);
+  REQUIRE(h.undo());
+  REQUIRE(grid.cells[30] == 0);
+  REQUIRE(grid.cells[10] == 1);
+}
+
+TEST_CASE("history: bounded number of versions") {
+  int value = 0;
+  history<int> h{value, 3};
+  for (int i = 1; i <= 10; ++i) {
+    value = i;
+    h.checkpoint();
+  }
+  REQUIRE(h.undo_count() == 3);
+  while (h.undo()) {}
+  REQUIRE(value == 7);
+
+  history_test_grid grid;
+  grid.cells.fill(0);
+  history<history_test_grid> bounded{grid, 64, 4096};
+  for (int i = 0; i < 100; ++i) {
+    grid.cells[static_cast<std::size_t>(i)] = i + 1;
+    grid.cells[static_cast<std::size_t>(i) + 5000] = i + 1;
+    bounded.checkpoint();
+  }
+  REQUIRE(bounded.memory_usage() <= sizeof(history_test_grid) + 4096);
+  REQUIRE(bounded.undo_count() < 100);
+}
+
+TEST_CASE("history: whole versions of not trivially copyable object") {
+  std::string text = "a";
+  history<std::string> h{text};
+  text += "b";
+  h.checkpoint();
+  text += "c";
+  h.checkpoint();
+  text += "d";
+  REQUIRE(h.undo());
+  REQUIRE(text == "ab");
+  REQUIRE(h.undo());
+  REQUIRE(text == "a");
+  REQUIRE(h.redo());
+  REQUIRE(text == "ab");
+}
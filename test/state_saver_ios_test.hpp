@@ -0,0 +1,134 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <iomanip>
+#include <locale>
+#include <sstream>
+#include <stdexcept>
+
+#include <catch.hpp>
+
+#include <state_saver_ios.hpp>
+
+TEST_CASE("saver_exit_ios: formatting state restored on scope leave") {
+  std::ostringstream stream;
+  const auto locale = stream.getloc();
+  {
+    SAVER_EXIT_IOS(stream);
+    stream.imbue(std::locale::classic());
+    stream << std::hex << std::setprecision(2) << std::setfill('*') << std::setw(10) << std::showbase;
+    stream.exceptions(std::ios_base::badbit);
+  }
+
+  REQUIRE(stream.flags() == std::ios_base::fmtflags(std::ios_base::skipws | std::ios_base::dec));
+  REQUIRE(stream.precision() == 6);
+  REQUIRE(stream.width() == 0);
+  REQUIRE(stream.fill() == ' ');
+  REQUIRE(stream.exceptions() == std::ios_base::goodbit);
+  REQUIRE(stream.getloc() == locale);
+
+  stream << 10;
+  REQUIRE(stream.str() == "10");
+}
+
+void ios_test_count_imbue(std::ios_base::event event, std::ios_base& stream, int index) {
+  if (event == std::ios_base::imbue_event) {
+    ++stream.iword(index);
+  }
+}
+
+TEST_CASE("saver_exit_ios: imbue skipped if locale did not change") {
+  std::ostringstream stream;
+  const int index = std::ios_base::xalloc();
+  stream.register_callback(&ios_test_count_imbue, index);
+  {
+    SAVER_EXIT_IOS(stream);
+    stream << std::hex << std::setw(4);
+  }
+  REQUIRE(stream.iword(index) == 0);
+
+  {
+    SAVER_EXIT_IOS(stream);
+    stream.imbue(std::locale{std::locale::classic(), new std::numpunct<char>{}});
+  }
+  REQUIRE(stream.iword(index) == 2);
+}
+
+TEST_CASE("saver_exit_ios: called on error") {
+  std::ostringstream stream;
+  REQUIRE_THROWS([&]() {
+    saver_exit_ios<decltype(stream)> saver{stream};
+    stream << std::hex << std::setw(4);
+    throw std::runtime_error{"error"};
+  }());
+
+  stream << 10;
+  REQUIRE(stream.str() == "10");
+}
+
+TEST_CASE("saver_exit_ios: dismiss and restore") {
+  std::ostringstream stream;
+  {
+    saver_exit_ios<decltype(stream)> saver{stream};
+    stream << std::hex;
+    saver.restore();
+    stream << 10;
+    stream << std::hex;
+    saver.dismiss();
+  }
+
+  stream << 10;
+  REQUIRE(stream.str() == "10a");
+}
+
+TEST_CASE("saver_exit_ios: macros") {
+  std::ostringstream stream;
+  WITH_SAVER_EXIT_IOS(stream) {
+    stream << std::hex;
+  }
+  REQUIRE_THROWS([&]() {
+    SAVER_FAIL_IOS(stream);
+    MAKE_SAVER_SUCCESS_IOS(saver, stream);
+    stream << std::hex;
+    throw std::runtime_error{"error"};
+  }());
+  WITH_SAVER_SUCCESS_IOS(stream) {
+    stream << std::oct;
+  }
+  WITH_SAVER_FAIL_IOS(stream) {
+    stream << 10;
+  }
+
+  REQUIRE(stream.str() == "10");
+}
+
+TEST_CASE("saver_fail_ios and saver_success_ios") {
+  std::wostringstream stream;
+  {
+    saver_fail_ios<decltype(stream)> saver_fail{stream};
+    saver_success_ios<decltype(stream)> saver_success{stream};
+    stream << std::hex;
+  }
+
+  stream << 10;
+  REQUIRE(stream.str() == L"10");
+}
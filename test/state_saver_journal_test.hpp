@@ -0,0 +1,184 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+#include <catch.hpp>
+
+#include <state_saver_journal.hpp>
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <sys/wait.h>
+
+struct journal_test_data {
+  int a;
+  double b;
+  char name[16];
+};
+
+struct journal_test_mapping {
+  std::string data_path;
+  std::string journal_path;
+  journal_test_data* data;
+
+  journal_test_mapping() : data_path{"/tmp/state_saver_journal_data.XXXXXX"}, journal_path{}, data{nullptr} {
+    const int fd = ::mkstemp(&data_path[0]);
+    REQUIRE(fd >= 0);
+    REQUIRE(::ftruncate(fd, sizeof(journal_test_data)) == 0);
+    journal_path = data_path + ".journal";
+    ::unlink(journal_path.c_str());
+    map(fd);
+  }
+
+  void map(int fd) {
+    void* p = ::mmap(nullptr, sizeof(journal_test_data), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    REQUIRE(p != MAP_FAILED);
+    data = static_cast<journal_test_data*>(p);
+  }
+
+  void remap() {
+    ::munmap(data, sizeof(journal_test_data));
+    map(::open(data_path.c_str(), O_RDWR));
+  }
+
+  ~journal_test_mapping() {
+    ::munmap(data, sizeof(journal_test_data));
+    ::unlink(data_path.c_str());
+    ::unlink(journal_path.c_str());
+  }
+};
+
+TEST_CASE("saver_exit_journal: rollback on scope leave") {
+  journal_test_mapping m;
+  undo_journal journal{m.journal_path.c_str(), m.data, sizeof(journal_test_data)};
+  REQUIRE(journal.recovered() == 0);
+  m.data->a = 1;
+  m.data->b = 2.0;
+
+  {
+    saver_exit_journal saver{journal, m.data->a, m.data->b};
+    m.data->a = 10;
+    m.data->b = 20.0;
+  }
+  REQUIRE(m.data->a == 1);
+  REQUIRE(m.data->b == 2.0);
+
+  REQUIRE_THROWS([&m, &journal]() {
+    saver_fail_journal saver{journal, *m.data};
+    m.data->a = 10;
+    {
+      saver_fail_journal nested{journal, m.data->b};
+      m.data->b = 20.0;
+    }
+    throw std::runtime_error{"error"};
+  }());
+  REQUIRE(m.data->a == 1);
+  REQUIRE(m.data->b == 2.0);
+
+  {
+    saver_success_journal saver{journal};
+    saver.save(m.data->name);
+    std::strcpy(m.data->name, "committed");
+    saver.dismiss();
+  }
+  REQUIRE(std::string{m.data->name} == "committed");
+
+  int outside = 0;
+  REQUIRE_THROWS_AS(saver_exit_journal(journal, outside), std::out_of_range);
+}
+
+TEST_CASE("saver_exit_journal: recovery after crash") {
+  journal_test_mapping m;
+  {
+    undo_journal journal{m.journal_path.c_str(), m.data, sizeof(journal_test_data)};
+    m.data->a = 1;
+    std::strcpy(m.data->name, "old");
+    {
+      saver_exit_journal saver{journal, m.data->a};
+      saver.dismiss();
+    }
+  }
+
+  const pid_t pid = ::fork();
+  REQUIRE(pid >= 0);
+  if (pid == 0) {
+    undo_journal journal{m.journal_path.c_str(), m.data, sizeof(journal_test_data)};
+    saver_fail_journal saver{journal, m.data->a, m.data->name};
+    m.data->a = 42;
+    std::strcpy(m.data->name, "half");
+    ::msync(m.data, sizeof(journal_test_data), MS_SYNC);
+    std::_Exit(0); // Crash in the middle of transaction.
+  }
+  int status = 0;
+  REQUIRE(::waitpid(pid, &status, 0) == pid);
+  m.remap();
+  REQUIRE(m.data->a == 42);
+
+  undo_journal journal{m.journal_path.c_str(), m.data, sizeof(journal_test_data)};
+  REQUIRE(journal.recovered() == 2);
+  REQUIRE(m.data->a == 1);
+  REQUIRE(std::string{m.data->name} == "old");
+
+  undo_journal reopened{m.journal_path.c_str(), m.data, sizeof(journal_test_data)};
+  REQUIRE(reopened.recovered() == 0);
+}
+
+TEST_CASE("saver_exit_journal: recovery after crash keeps records of rolled back nested scope") {
+  journal_test_mapping m;
+  m.data->a = 1;
+  m.data->b = 2.0;
+  std::strcpy(m.data->name, "old");
+  ::msync(m.data, sizeof(journal_test_data), MS_SYNC);
+
+  const pid_t pid = ::fork();
+  REQUIRE(pid >= 0);
+  if (pid == 0) {
+    undo_journal journal{m.journal_path.c_str(), m.data, sizeof(journal_test_data)};
+    saver_fail_journal saver{journal, m.data->a};
+    m.data->a = 42;
+    {
+      saver_exit_journal nested{journal, m.data->b};
+      m.data->b = 20.0;
+      ::msync(m.data, sizeof(journal_test_data), MS_SYNC);
+    }
+    // Restored b is not synced yet, the nested record must survive the next append.
+    saver.save(m.data->name);
+    std::strcpy(m.data->name, "half");
+    std::_Exit(0); // Crash in the middle of transaction.
+  }
+  int status = 0;
+  REQUIRE(::waitpid(pid, &status, 0) == pid);
+  m.remap();
+
+  undo_journal journal{m.journal_path.c_str(), m.data, sizeof(journal_test_data)};
+  REQUIRE(journal.recovered() == 3);
+  REQUIRE(m.data->a == 1);
+  REQUIRE(m.data->b == 2.0);
+  REQUIRE(std::string{m.data->name} == "old");
+}
+
+#endif
@@ -0,0 +1,133 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <stdexcept>
+#include <string>
+
+#include <catch.hpp>
+
+#include <state_saver_outermost.hpp>
+
+struct outermost_test_counted {
+  static int copies;
+  int value;
+
+  explicit outermost_test_counted(int v) : value{v} {}
+  outermost_test_counted(const outermost_test_counted& other) : value{other.value} {
+    ++copies;
+  }
+  outermost_test_counted& operator=(const outermost_test_counted&) = default;
+};
+
+int outermost_test_counted::copies = 0;
+
+static void outermost_test_recurse(outermost_test_counted& x, int depth) {
+  SAVER_EXIT_OUTERMOST(x);
+  x.value = depth;
+  if (depth < 100) {
+    outermost_test_recurse(x, depth + 1);
+  }
+}
+
+TEST_CASE("saver_exit_outermost: only outermost saver copies the object") {
+  outermost_test_counted x{-1};
+  outermost_test_counted::copies = 0;
+  outermost_test_recurse(x, 0);
+  REQUIRE(x.value == -1);
+  REQUIRE(outermost_test_counted::copies == 1);
+}
+
+TEST_CASE("saver_exit_outermost: nested savers are no-op") {
+  int x = 1;
+  int y = 10;
+  {
+    saver_exit_outermost<int> outer{x};
+    REQUIRE(outer.active());
+    x = 2;
+    {
+      saver_exit_outermost<int> inner{x};
+      REQUIRE_FALSE(inner.active());
+      saver_exit_outermost<int> other{y};
+      REQUIRE(other.active());
+      saver_fail_outermost<int> other_policy{x};
+      REQUIRE(other_policy.active());
+      x = 3;
+      y = 20;
+    }
+    REQUIRE(x == 3);
+    REQUIRE(y == 10);
+  }
+  REQUIRE(x == 1);
+
+  {
+    saver_exit_outermost<int> again{x};
+    REQUIRE(again.active());
+  }
+
+  REQUIRE_THROWS([&x]() {
+    saver_fail_outermost<int> outer{x};
+    x = 2;
+    saver_fail_outermost<int> inner{x};
+    x = 3;
+    throw std::runtime_error{"error"};
+  }());
+  REQUIRE(x == 1);
+
+  std::string s = "a";
+  {
+    saver_success_outermost<std::string> outer{s};
+    s = "b";
+    outer.dismiss();
+  }
+  REQUIRE(s == "b");
+}
+
+TEST_CASE("saver_exit_outermost: macros") {
+  int x = 1;
+  WITH_SAVER_EXIT_OUTERMOST(x) {
+    x = 2;
+    WITH_SAVER_EXIT_OUTERMOST(x) {
+      x = 3;
+    }
+    REQUIRE(x == 3);
+  }
+  REQUIRE(x == 1);
+
+  REQUIRE_THROWS([&x]() {
+    SAVER_FAIL_OUTERMOST(x);
+    MAKE_SAVER_SUCCESS_OUTERMOST(saver, x);
+    REQUIRE(saver.active());
+    x = 2;
+    throw std::runtime_error{"error"};
+  }());
+  REQUIRE(x == 1);
+
+  WITH_SAVER_SUCCESS_OUTERMOST(x) {
+    x = 2;
+  }
+  REQUIRE(x == 1);
+
+  WITH_SAVER_FAIL_OUTERMOST(x) {
+    x = 2;
+  }
+  REQUIRE(x == 2);
+}
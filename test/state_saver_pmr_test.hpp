@@ -0,0 +1,123 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <thread>
+
+#include <catch.hpp>
+
+#include <state_saver_pmr.hpp>
+
+#if defined(NEARGYE_STATE_SAVER_PMR)
+
+#include <vector>
+
+class counting_resource : public std::pmr::memory_resource {
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+    ++allocations;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+    ++deallocations;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+
+ public:
+  std::atomic<int> allocations{0};
+  std::atomic<int> deallocations{0};
+};
+
+TEST_CASE("saver_exit_default_resource: process-wide default resource") {
+  std::pmr::memory_resource* previous = std::pmr::get_default_resource();
+  counting_resource resource;
+  {
+    saver_exit_default_resource saver{&resource};
+    REQUIRE(std::pmr::get_default_resource() == &resource);
+  }
+  REQUIRE(std::pmr::get_default_resource() == previous);
+
+  REQUIRE_THROWS([&]() {
+    saver_fail_default_resource saver{&resource};
+    throw std::runtime_error{"error"};
+  }());
+  REQUIRE(std::pmr::get_default_resource() == previous);
+
+  {
+    saver_success_default_resource saver{&resource};
+  }
+  REQUIRE(std::pmr::get_default_resource() == previous);
+}
+
+TEST_CASE("saver_exit_thread_resource: thread default resource") {
+  saver_exit_default_resource install{thread_default_resource()};
+  counting_resource arena;
+  std::pmr::vector<int> outer;
+  {
+    saver_exit_thread_resource saver{&arena};
+    std::pmr::vector<int> inner;
+    inner.push_back(1);
+    outer.push_back(1);
+    REQUIRE(arena.allocations.load() == 2);
+
+    std::atomic<int> other_thread_allocations{-1};
+    std::thread thread{[&]() {
+      std::pmr::vector<int> other;
+      other.push_back(1);
+      other_thread_allocations = arena.allocations.load();
+    }};
+    thread.join();
+    REQUIRE(other_thread_allocations.load() == 2);
+  }
+  REQUIRE(arena.deallocations.load() == 1);
+
+  // Block allocated from the arena is deallocated to the arena after scope exit.
+  outer.clear();
+  outer.shrink_to_fit();
+  REQUIRE(arena.deallocations.load() == 2);
+
+  std::pmr::vector<int> after;
+  after.push_back(1);
+  REQUIRE(arena.allocations.load() == 2);
+}
+
+TEST_CASE("saver_fail_thread_resource and saver_success_thread_resource") {
+  saver_exit_default_resource install{thread_default_resource()};
+  counting_resource arena;
+  REQUIRE_THROWS([&]() {
+    saver_fail_thread_resource saver_fail{&arena};
+    saver_success_thread_resource saver_success{&arena};
+    throw std::runtime_error{"error"};
+  }());
+
+  std::pmr::vector<int> after;
+  after.push_back(1);
+  REQUIRE(arena.allocations.load() == 0);
+}
+
+#endif
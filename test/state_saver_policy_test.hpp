@@ -0,0 +1,195 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <chrono>
+
+#include <catch.hpp>
+
+#include <state_saver.hpp>
+
+namespace {
+
+// Cancellation token driven policy, restore is skipped once the token was cancelled.
+std::atomic<bool> cancel_token{false};
+
+class on_not_cancelled_policy {
+  bool execute_;
+
+ public:
+  explicit on_not_cancelled_policy(bool execute) noexcept : execute_{execute} {}
+
+  void dismiss() noexcept {
+    execute_ = false;
+  }
+
+  bool should_execute() const noexcept {
+    return execute_ && !cancel_token.load(std::memory_order_relaxed);
+  }
+};
+
+// Deadline policy, restore happens only if the scope finished before the deadline.
+class on_deadline_policy {
+  std::chrono::steady_clock::time_point deadline_;
+
+ public:
+  explicit on_deadline_policy(bool execute) noexcept
+      : deadline_{execute ? std::chrono::steady_clock::now() + std::chrono::hours{1} : std::chrono::steady_clock::time_point::min()} {}
+
+  void dismiss() noexcept {
+    deadline_ = std::chrono::steady_clock::time_point::min();
+  }
+
+  bool should_execute() const noexcept {
+    return std::chrono::steady_clock::now() < deadline_;
+  }
+};
+
+// Per-thread error slot policy, restore happens only if an error was reported during the scope.
+int& error_slot() noexcept {
+  static thread_local int error = 0;
+  return error;
+}
+
+class on_error_slot_policy {
+  int error_;
+
+ public:
+  explicit on_error_slot_policy(bool execute) noexcept : error_{execute ? error_slot() : -1} {}
+
+  void dismiss() noexcept {
+    error_ = -1;
+  }
+
+  bool should_execute() const noexcept {
+    return error_ != -1 && error_ != error_slot();
+  }
+};
+
+struct missing_dismiss_policy {
+  explicit missing_dismiss_policy(bool) noexcept {}
+  bool should_execute() const noexcept { return true; }
+};
+
+struct throwing_policy {
+  explicit throwing_policy(bool) noexcept(false) {}
+  void dismiss() noexcept {}
+  bool should_execute() const noexcept { return true; }
+};
+
+struct implicit_policy {
+  implicit_policy(bool) noexcept {}
+  void dismiss() noexcept {}
+  bool should_execute() const noexcept { return true; }
+};
+
+static_assert(!is_saver_policy<int>::value, "");
+static_assert(!is_saver_policy<implicit_policy>::value, "");
+static_assert(!is_saver_policy<missing_dismiss_policy>::value, "");
+static_assert(!is_saver_policy<throwing_policy>::value, "");
+
+// Requirements every policy must pass to be used with state_saver.
+template <typename P>
+void check_policy_conformance() {
+  static_assert(is_saver_policy<P>::value, "policy does not satisfy the state_saver policy concept.");
+  static_assert(!std::is_convertible<bool, P>::value, "policy constructor must be explicit.");
+
+  {
+    const P policy{false};
+    REQUIRE_FALSE(policy.should_execute());
+  }
+  {
+    P policy{true};
+    policy.dismiss();
+    REQUIRE_FALSE(policy.should_execute());
+    policy.dismiss();
+    REQUIRE_FALSE(policy.should_execute());
+  }
+  {
+    int a = 1;
+    {
+      basic_saver<decltype(a), P> saver{a};
+      a = 2;
+      saver.dismiss();
+    }
+    REQUIRE(a == 2);
+  }
+  {
+    int a = 1;
+    {
+      basic_saver<decltype(a), P> saver{a};
+      a = 2;
+      saver.restore();
+      REQUIRE(a == 1);
+      a = 3;
+      saver.dismiss();
+    }
+    REQUIRE(a == 3);
+  }
+}
+
+} // namespace
+
+TEST_CASE("policy: built-in policies conformance") {
+  check_policy_conformance<on_exit_policy>();
+  check_policy_conformance<on_fail_policy>();
+  check_policy_conformance<on_success_policy>();
+}
+
+TEST_CASE("policy: user-defined policies conformance") {
+  check_policy_conformance<on_not_cancelled_policy>();
+  check_policy_conformance<on_deadline_policy>();
+  check_policy_conformance<on_error_slot_policy>();
+}
+
+TEST_CASE("policy: cancellation token policy") {
+  int a = 1;
+  {
+    basic_saver<decltype(a), on_not_cancelled_policy> saver{a};
+    a = 2;
+  }
+  REQUIRE(a == 1);
+
+  {
+    basic_saver<decltype(a), on_not_cancelled_policy> saver{a};
+    a = 2;
+    cancel_token.store(true);
+  }
+  cancel_token.store(false);
+  REQUIRE(a == 2);
+}
+
+TEST_CASE("policy: error slot policy") {
+  int a = 1;
+  {
+    basic_saver<decltype(a), on_error_slot_policy> saver{a};
+    a = 2;
+  }
+  REQUIRE(a == 2);
+
+  {
+    basic_saver<decltype(a), on_error_slot_policy> saver{a};
+    a = 3;
+    ++error_slot();
+  }
+  REQUIRE(a == 2);
+}
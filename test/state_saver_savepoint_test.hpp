@@ -0,0 +1,113 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <catch.hpp>
+
+#include <state_saver_savepoint.hpp>
+
+TEST_CASE("saver_exit_transaction: rollback_to savepoint") {
+  int a = 1;
+  std::string b = "b";
+  std::vector<int> c = {1, 2, 3};
+
+  {
+    saver_exit_transaction tx{a, b};
+    a = 2;
+    b = "bb";
+
+    const auto sp1 = tx.savepoint();
+    tx.save(c);
+    c.push_back(4);
+    const auto sp2 = tx.savepoint();
+    tx.save(a);
+    a = 3;
+
+    tx.rollback_to(sp2);
+    REQUIRE(a == 2);
+    REQUIRE(c.size() == 4);
+
+    tx.rollback_to(sp1);
+    REQUIRE(c == std::vector<int>{1, 2, 3});
+    REQUIRE(b == "bb");
+
+    c.clear();
+    REQUIRE_THROWS_AS(tx.rollback_to(tx.savepoint() + 1), std::out_of_range);
+  }
+  REQUIRE(a == 1);
+  REQUIRE(b == "b");
+  REQUIRE(c.empty());
+}
+
+TEST_CASE("saver_exit_transaction: release savepoint") {
+  int a = 1;
+  std::string b = "b";
+
+  {
+    saver_fail_transaction tx{a};
+    a = 2;
+    const auto sp = tx.savepoint();
+    tx.save(a, b);
+    a = 3;
+    b = "bb";
+    tx.release(sp);
+    REQUIRE(tx.savepoint() > sp); // Record of b is kept, record of a is dropped.
+    tx.rollback_to(sp);
+    REQUIRE(a == 3);
+    REQUIRE(b == "b");
+  }
+  REQUIRE(a == 3);
+
+  REQUIRE_THROWS([&a, &b]() {
+    saver_fail_transaction tx{b};
+    b = "c";
+    const auto sp = tx.savepoint();
+    tx.save(b, a);
+    a = 4;
+    b = "d";
+    tx.release(sp);
+    throw std::runtime_error{"error"};
+  }());
+  REQUIRE(a == 3);
+  REQUIRE(b == "b");
+}
+
+TEST_CASE("saver_exit_transaction: contiguous stack grows") {
+  std::vector<std::string> values(1000);
+  {
+    saver_success_transaction tx;
+    for (std::size_t i = 0; i < values.size(); ++i) {
+      tx.save(values[i]);
+      values[i] = std::to_string(i);
+    }
+    tx.rollback_to(tx.savepoint()); // No-op.
+    REQUIRE(values[999] == "999");
+    tx.restore();
+    REQUIRE(values[999].empty());
+    values[0] = "x";
+    tx.dismiss();
+  }
+  REQUIRE(values[0] == "x");
+}
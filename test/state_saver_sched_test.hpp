@@ -0,0 +1,111 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+#include <catch.hpp>
+
+#include <state_saver_sched.hpp>
+
+#if defined(__linux__)
+
+TEST_CASE("saver_exit_affinity: affinity restored on scope leave") {
+  const cpu_set_t previous = state_saver::detail::affinity_traits::get();
+  int cpu = 0;
+  while (!CPU_ISSET(cpu, &previous)) {
+    ++cpu;
+  }
+  cpu_set_t pinned;
+  CPU_ZERO(&pinned);
+  CPU_SET(cpu, &pinned);
+
+  {
+    saver_exit_affinity saver{pinned};
+    const cpu_set_t current = state_saver::detail::affinity_traits::get();
+    REQUIRE(CPU_EQUAL(&current, &pinned));
+  }
+  const cpu_set_t current = state_saver::detail::affinity_traits::get();
+  REQUIRE(CPU_EQUAL(&current, &previous));
+}
+
+TEST_CASE("saver_exit_timer_slack: timer slack restored on scope leave") {
+  const unsigned long previous = state_saver::detail::timer_slack_traits::get();
+  {
+    saver_exit_timer_slack saver{previous + 1000};
+    REQUIRE(state_saver::detail::timer_slack_traits::get() == previous + 1000);
+  }
+  REQUIRE(state_saver::detail::timer_slack_traits::get() == previous);
+
+  REQUIRE_THROWS([previous]() {
+    saver_fail_timer_slack saver{previous + 1000};
+    throw std::runtime_error{"error"};
+  }());
+  REQUIRE(state_saver::detail::timer_slack_traits::get() == previous);
+
+  {
+    saver_success_timer_slack saver{previous + 1000};
+    saver.dismiss();
+  }
+  REQUIRE(state_saver::detail::timer_slack_traits::get() == previous + 1000);
+  state_saver::detail::timer_slack_traits::set(previous);
+}
+
+TEST_CASE("saver_exit_sched: nice value restored on scope leave") {
+  // Runs in own thread, nice value is per thread and raising it is allowed without privileges.
+  sched_state previous;
+  sched_state raised;
+  sched_state after_restore;
+  sched_state after_noop;
+  bool restored = false;
+  std::thread{[&]() {
+    previous = state_saver::detail::sched_traits::get();
+    sched_state lower = previous;
+    lower.nice = previous.nice + 1;
+    saver_exit_sched saver{lower};
+    raised = state_saver::detail::sched_traits::get();
+    try {
+      saver.restore();
+      restored = true;
+    } catch (const std::system_error&) {
+      // Lowering nice value back requires CAP_SYS_NICE or RLIMIT_NICE.
+    }
+    saver.dismiss();
+    after_restore = state_saver::detail::sched_traits::get();
+    {
+      saver_exit_sched noop{after_restore}; // Unchanged, restore makes no syscall.
+    }
+    after_noop = state_saver::detail::sched_traits::get();
+  }}.join();
+
+  REQUIRE(raised.nice == previous.nice + 1);
+  REQUIRE(after_noop.nice == after_restore.nice);
+  if (restored) {
+    REQUIRE(after_restore.nice == previous.nice);
+  } else {
+    WARN("saver_exit_sched: restoring lower nice value is not permitted, restore path skipped.");
+    REQUIRE(after_restore.nice == raised.nice);
+  }
+}
+
+#endif
@@ -0,0 +1,81 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <array>
+#include <stdexcept>
+#include <string>
+
+#include <catch.hpp>
+
+#include <state_saver_small.hpp>
+
+struct small_test_big {
+  std::array<char, 16 * 1024> bytes;
+  std::string name;
+};
+
+TEST_CASE("small_storage: large snapshot does not grow the saver") {
+  static_assert(sizeof(saver_exit<small_test_big, small_storage>) <= 4 * sizeof(void*), "");
+  static_assert(sizeof(saver_exit<int, small_storage>) == sizeof(saver_exit<int>), "");
+  static_assert(sizeof(saver_exit<small_test_big, basic_small_storage<sizeof(small_test_big)>>) > sizeof(small_test_big), "");
+
+  small_test_big big;
+  big.bytes.fill('a');
+  big.name = "big";
+
+  {
+    saver_exit<small_test_big, small_storage> saver{big};
+    big.bytes.fill('b');
+    big.name = "changed";
+    saver.restore();
+    REQUIRE(big.bytes[100] == 'a');
+    big.name = "changed";
+  }
+  REQUIRE(big.bytes[0] == 'a');
+  REQUIRE(big.name == "big");
+
+  REQUIRE_THROWS([&big]() {
+    saver_fail<small_test_big, small_storage> saver{big};
+    big.name = "changed";
+    throw std::runtime_error{"error"};
+  }());
+  REQUIRE(big.name == "big");
+
+  {
+    saver_success<small_test_big, small_storage> saver{big};
+    big.name = "kept";
+    saver.dismiss();
+  }
+  REQUIRE(big.name == "kept");
+}
+
+TEST_CASE("small_storage: pool reuses blocks") {
+  auto& pool = state_saver::detail::snapshot_pool::local();
+  void* p = pool.allocate(1000);
+  pool.deallocate(p, 1000);
+  void* q = pool.allocate(900);
+  REQUIRE(p == q);
+  pool.deallocate(q, 900);
+
+  void* huge = pool.allocate(std::size_t{16} << 20);
+  pool.deallocate(huge, std::size_t{16} << 20);
+}
@@ -0,0 +1,103 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <catch.hpp>
+
+#include <state_saver_spill.hpp>
+
+#if defined(__unix__) || defined(__APPLE__)
+
+struct spill_test_big {
+  int values[4096];
+};
+
+struct spill_test_document {
+  std::string title;
+  std::vector<int> lines;
+};
+
+inline void snapshot_write(const spill_test_document& d, snapshot_writer& writer) {
+  const std::size_t sizes[2] = {d.title.size(), d.lines.size()};
+  writer.write(sizes, sizeof(sizes));
+  writer.write(d.title.data(), d.title.size());
+  writer.write(d.lines.data(), d.lines.size() * sizeof(int));
+}
+
+inline void snapshot_read(spill_test_document& d, snapshot_reader& reader) {
+  std::size_t sizes[2];
+  reader.read(sizes, sizeof(sizes));
+  d.title.resize(sizes[0]);
+  d.lines.resize(sizes[1]);
+  reader.read(&d.title[0], d.title.size());
+  reader.read(d.lines.data(), d.lines.size() * sizeof(int));
+}
+
+TEST_CASE("spill_storage: trivially copyable snapshot restored from file") {
+  static_assert(is_saver_storage<spill_storage, spill_test_big>::value, "");
+
+  spill_test_big big;
+  for (int i = 0; i < 4096; ++i) {
+    big.values[i] = i;
+  }
+
+  {
+    saver_exit<spill_test_big, spill_storage> saver{big};
+    std::memset(big.values, 0, sizeof(big.values));
+  }
+  REQUIRE(big.values[0] == 0);
+  REQUIRE(big.values[4095] == 4095);
+
+  REQUIRE_THROWS([&big]() {
+    saver_fail<spill_test_big, spill_storage> saver{big};
+    big.values[100] = -1;
+    throw std::runtime_error{"error"};
+  }());
+  REQUIRE(big.values[100] == 100);
+
+  {
+    saver_success<spill_test_big, spill_storage> saver{big};
+    big.values[100] = -1;
+    saver.restore();
+    REQUIRE(big.values[100] == 100);
+    big.values[100] = -1;
+    saver.dismiss();
+  }
+  REQUIRE(big.values[100] == -1);
+}
+
+TEST_CASE("spill_storage: snapshot_write/snapshot_read customization") {
+  spill_test_document d{"title", {1, 2, 3}};
+  {
+    saver_exit<spill_test_document, spill_storage> saver{d};
+    d.title = "changed";
+    d.lines.assign(100, 0);
+  }
+  REQUIRE(d.title == "title");
+  REQUIRE(d.lines == std::vector<int>{1, 2, 3});
+}
+
+#endif
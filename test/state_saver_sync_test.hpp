@@ -0,0 +1,362 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2018 - 2020 Daniil Goncharov <neargye@gmail.com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch.hpp>
+
+#include <state_saver_sync.hpp>
+
+struct seqlock_pair {
+  long first = 1;
+  long second = -1;
+  char padding[40] = {};
+
+  seqlock_pair() = default;
+  explicit seqlock_pair(long value) : first{value}, second{-value} {}
+};
+
+TEST_CASE("saver_exit_seqlock: called on scope leave") {
+  seqlocked<seqlock_pair> shared;
+  {
+    saver_exit_seqlock<decltype(shared)> saver{shared, seqlock_pair{2}};
+    REQUIRE(shared.load().first == 2);
+  }
+  REQUIRE(shared.load().first == 1);
+
+  REQUIRE_THROWS([&]() {
+    saver_exit_seqlock<decltype(shared)> saver{shared};
+    shared.store(seqlock_pair{3});
+    throw std::runtime_error{"error"};
+  }());
+  REQUIRE(shared.load().first == 1);
+}
+
+TEST_CASE("saver_exit_seqlock: dismiss and restore") {
+  seqlocked<int> shared{1};
+  {
+    saver_exit_seqlock<decltype(shared)> saver{shared, 2};
+    saver.restore();
+    REQUIRE(shared.load() == 1);
+    shared.store(3);
+    saver.dismiss();
+  }
+  REQUIRE(shared.load() == 3);
+}
+
+TEST_CASE("saver_fail_seqlock and saver_success_seqlock") {
+  seqlocked<int> shared{1};
+  {
+    saver_fail_seqlock<decltype(shared)> saver{shared, 2};
+  }
+  REQUIRE(shared.load() == 2);
+  {
+    saver_success_seqlock<decltype(shared)> saver{shared, 3};
+  }
+  REQUIRE(shared.load() == 2);
+}
+
+TEST_CASE("saver_exit_seqlock: readers never observe torn values") {
+  seqlocked<seqlock_pair> shared;
+  std::atomic<bool> stop{false};
+  std::atomic<long> torn{0};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; ++i) {
+    readers.emplace_back([&]() {
+      while (!stop.load(std::memory_order_relaxed)) {
+        const seqlock_pair value = shared.load();
+        if (value.first != -value.second) {
+          ++torn;
+        }
+      }
+    });
+  }
+
+  for (long i = 2; i < 20000; ++i) {
+    saver_exit_seqlock<decltype(shared)> saver{shared, seqlock_pair{i}};
+  }
+  stop.store(true);
+  for (auto& reader : readers) {
+    reader.join();
+  }
+
+  REQUIRE(torn.load() == 0);
+  REQUIRE(shared.load().first == 1);
+}
+
+TEST_CASE("saver_exit_seqlock: concurrent exchange loses no writes") {
+  seqlocked<long> shared{0};
+  std::vector<long> previous[4];
+  std::vector<std::thread> writers;
+  for (long t = 0; t < 4; ++t) {
+    writers.emplace_back([&shared, &previous, t]() {
+      for (long i = 1; i <= 10000; ++i) {
+        previous[t].push_back(shared.exchange(t * 100000 + i));
+      }
+    });
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+
+  // Every written value is returned by exactly one exchange or is the final value.
+  std::vector<long> seen{shared.load()};
+  for (const auto& values : previous) {
+    seen.insert(seen.end(), values.begin(), values.end());
+  }
+  std::sort(seen.begin(), seen.end());
+  std::vector<long> expected{0};
+  for (long t = 0; t < 4; ++t) {
+    for (long i = 1; i <= 10000; ++i) {
+      expected.push_back(t * 100000 + i);
+    }
+  }
+  REQUIRE(seen == expected);
+}
+
+struct shared_config {
+  int level;
+};
+
+TEST_CASE("saver_exit_shared_ptr: called on scope leave") {
+  auto config = std::make_shared<const shared_config>();
+  std::shared_ptr<const shared_config> slot = config;
+  {
+    saver_exit_shared_ptr<decltype(slot)> saver{slot};
+    std::atomic_store(&slot, std::make_shared<const shared_config>(shared_config{2}));
+    REQUIRE(std::atomic_load(&slot)->level == 2);
+  }
+  REQUIRE(std::atomic_load(&slot) == config);
+
+  REQUIRE_THROWS([&]() {
+    saver_exit_shared_ptr<decltype(slot)> saver{slot, std::make_shared<const shared_config>(shared_config{3})};
+    throw std::runtime_error{"error"};
+  }());
+  REQUIRE(std::atomic_load(&slot) == config);
+}
+
+TEST_CASE("saver_exit_shared_ptr: conditional restore") {
+  auto config = std::make_shared<const shared_config>();
+  auto other = std::make_shared<const shared_config>(shared_config{3});
+  std::shared_ptr<const shared_config> slot = config;
+  {
+    saver_exit_shared_ptr<decltype(slot)> saver{slot, std::make_shared<const shared_config>(shared_config{2})};
+    REQUIRE(std::atomic_load(&slot)->level == 2);
+    std::atomic_store(&slot, other); // Concurrent publisher, restore must not stomp on it.
+  }
+  REQUIRE(std::atomic_load(&slot) == other);
+
+  {
+    saver_exit_shared_ptr<decltype(slot)> saver{slot, config};
+    REQUIRE(saver.restore());
+    REQUIRE(std::atomic_load(&slot) == other);
+    saver.dismiss();
+  }
+  REQUIRE(std::atomic_load(&slot) == other);
+}
+
+TEST_CASE("saver_fail_shared_ptr and saver_success_shared_ptr") {
+  auto config = std::make_shared<const shared_config>();
+  std::shared_ptr<const shared_config> slot = config;
+  {
+    saver_fail_shared_ptr<decltype(slot)> saver{slot, std::make_shared<const shared_config>(shared_config{2})};
+  }
+  REQUIRE(std::atomic_load(&slot)->level == 2);
+  std::atomic_store(&slot, config);
+  {
+    saver_success_shared_ptr<decltype(slot)> saver{slot, std::make_shared<const shared_config>(shared_config{2})};
+  }
+  REQUIRE(std::atomic_load(&slot) == config);
+}
+
+#if defined(__cpp_lib_atomic_shared_ptr) && __cpp_lib_atomic_shared_ptr >= 201711L
+TEST_CASE("saver_exit_shared_ptr: atomic shared_ptr slot") {
+  auto config = std::make_shared<const shared_config>();
+  std::atomic<std::shared_ptr<const shared_config>> slot{config};
+  {
+    saver_exit_shared_ptr<decltype(slot)> saver{slot, std::make_shared<const shared_config>(shared_config{2})};
+    REQUIRE(slot.load()->level == 2);
+  }
+  REQUIRE(slot.load() == config);
+}
+#endif
+
+struct rcu_test_config {
+  static std::atomic<int> destroyed;
+  long value;
+  long check;
+
+  explicit rcu_test_config(long v) : value{v}, check{-v} {}
+  ~rcu_test_config() {
+    check = 0;
+    ++destroyed;
+  }
+};
+
+std::atomic<int> rcu_test_config::destroyed{0};
+
+TEST_CASE("saver_exit_shared_ptr: rcu slot defers reclamation while readers are inside") {
+  rcu_test_config::destroyed = 0;
+  rcu_slot<const rcu_test_config> slot{std::make_shared<const rcu_test_config>(1)};
+  {
+    rcu_read_guard guard;
+    const rcu_test_config* old = slot.get();
+    {
+      saver_exit_shared_ptr<decltype(slot)> saver{slot, std::make_shared<const rcu_test_config>(2)};
+      REQUIRE(slot.get()->value == 2);
+    }
+    REQUIRE(slot.get()->value == 1);
+    REQUIRE(rcu_test_config::destroyed == 0); // Override is retired, the reader may still hold it.
+    REQUIRE(old->value == 1);
+  }
+  slot.reclaim();
+  REQUIRE(slot.retired_count() == 0);
+  REQUIRE(rcu_test_config::destroyed == 1);
+
+  auto other = std::make_shared<const rcu_test_config>(3);
+  {
+    saver_exit_shared_ptr<decltype(slot)> saver{slot, std::make_shared<const rcu_test_config>(2)};
+    slot.store(other); // Concurrent publisher, restore must not stomp on it.
+  }
+  REQUIRE(slot.load() == other);
+}
+
+TEST_CASE("saver_exit_shared_ptr: rcu readers never see released config") {
+  rcu_slot<const rcu_test_config> slot{std::make_shared<const rcu_test_config>(1)};
+  std::atomic<bool> stop{false};
+  std::atomic<long> errors{0};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; ++i) {
+    readers.emplace_back([&]() {
+      while (!stop.load(std::memory_order_relaxed)) {
+        rcu_read_guard guard;
+        const rcu_test_config* config = slot.get();
+        if (config->value != -config->check) {
+          ++errors;
+        }
+      }
+    });
+  }
+
+  for (long i = 2; i < 20000; ++i) {
+    saver_exit_shared_ptr<decltype(slot)> saver{slot, std::make_shared<const rcu_test_config>(i)};
+  }
+  stop = true;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  slot.reclaim();
+
+  REQUIRE(errors == 0);
+  REQUIRE(slot.load()->value == 1);
+  REQUIRE(slot.retired_count() == 0);
+}
+
+class counting_shared_mutex {
+  std::mutex mutex_;
+
+ public:
+  int exclusive = 0;
+  int shared = 0;
+
+  void lock() {
+    mutex_.lock();
+    ++exclusive;
+  }
+
+  void unlock() {
+    mutex_.unlock();
+  }
+
+  void lock_shared() {
+    mutex_.lock();
+    ++shared;
+  }
+
+  void unlock_shared() {
+    mutex_.unlock();
+  }
+};
+
+TEST_CASE("saver_exit_locked: called on scope leave") {
+  std::string value = "value";
+  std::mutex mutex;
+  {
+    saver_exit_locked<decltype(value), decltype(mutex)> saver{value, mutex};
+    std::lock_guard<std::mutex> lock{mutex};
+    value = "other";
+  }
+  REQUIRE(value == "value");
+
+  REQUIRE_THROWS([&]() {
+    saver_exit_locked<decltype(value), decltype(mutex)> saver{value, mutex};
+    value = "other";
+    throw std::runtime_error{"error"};
+  }());
+  REQUIRE(value == "value");
+}
+
+TEST_CASE("saver_exit_locked: snapshot under shared lock, restore under exclusive lock") {
+  std::string value = "value";
+  counting_shared_mutex mutex;
+  {
+    saver_exit_locked<decltype(value), decltype(mutex)> saver{value, mutex};
+    REQUIRE(mutex.shared == 1);
+    REQUIRE(mutex.exclusive == 0);
+    value = "other";
+  }
+  REQUIRE(value == "value");
+  REQUIRE(mutex.shared == 1);
+  REQUIRE(mutex.exclusive == 1);
+}
+
+TEST_CASE("saver_exit_locked: dismiss and restore") {
+  std::string value = "value";
+  std::mutex mutex;
+  {
+    saver_exit_locked<decltype(value), decltype(mutex)> saver{value, mutex};
+    value = "other";
+    saver.restore();
+    REQUIRE(value == "value");
+    value = "other";
+    saver.dismiss();
+  }
+  REQUIRE(value == "other");
+}
+
+TEST_CASE("saver_fail_locked and saver_success_locked") {
+  int value = 1;
+  std::mutex mutex;
+  {
+    saver_fail_locked<decltype(value), decltype(mutex)> saver_fail{value, mutex};
+    saver_success_locked<decltype(value), decltype(mutex)> saver_success{value, mutex};
+    value = 2;
+  }
+  REQUIRE(value == 1);
+}
@@ -49,3 +49,26 @@
 #include "state_saver_success_test.hpp"
 #include "state_saver_fail_test.hpp"
 #undef CASE_NUMBER
+
+#include "state_saver_policy_test.hpp"
+#include "state_saver_fields_test.hpp"
+#include "state_saver_diff_test.hpp"
+#include "state_saver_bits_test.hpp"
+#include "state_saver_atomic_test.hpp"
+#include "state_saver_sync_test.hpp"
+#include "state_saver_dynamic_test.hpp"
+#include "state_saver_coro_test.hpp"
+#include "state_saver_fiber_test.hpp"
+#include "state_saver_fpenv_test.hpp"
+#include "state_saver_pmr_test.hpp"
+#include "state_saver_ios_test.hpp"
+#include "state_saver_sched_test.hpp"
+#include "state_saver_file_test.hpp"
+#include "state_saver_journal_test.hpp"
+#include "state_saver_spill_test.hpp"
+#include "state_saver_compress_test.hpp"
+#include "state_saver_history_test.hpp"
+#include "state_saver_savepoint_test.hpp"
+#include "state_saver_outermost_test.hpp"
+#include "state_saver_small_test.hpp"
+#include "state_saver_arena_test.hpp"